@@ -0,0 +1,414 @@
+#include <Backends/StandInWorkerBackend.h>
+
+#include <Backends/TrackerCommands.h>
+#include <FrameSources/FrameSource.h>
+#include <Helpers/DataProcessingHelpers.h>
+#include <Helpers/ImageHelpers.h>
+
+#include <nlohmann/json.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace nlohmann;
+
+namespace
+{
+constexpr auto lineModelKeyPrefix = "imageLineModel_";
+constexpr auto injectImageKeyPrefix = "injectImage_";
+constexpr auto textureKeyPrefix = "mappedTexture";
+
+// Returns the index following the prefix, e.g. 1 for "injectImage_1" and prefix "injectImage_"
+std::optional<size_t> parseIndexedKey(const std::string& key, const char* prefix)
+{
+    const auto prefixLength = std::strlen(prefix);
+    if (key.compare(0, prefixLength, prefix) != 0)
+    {
+        return std::nullopt;
+    }
+    const auto* begin = key.c_str() + prefixLength;
+    char* end;
+    const auto index = std::strtoul(begin, &end, 10);
+    if (end == begin || *end != '\0')
+    {
+        return std::nullopt;
+    }
+    return index;
+}
+
+// Hashes the brightest channel of a grid of pixels, so that an image stored as grey or BGR has
+// the same fingerprint when injected as grey or RGB
+uint64_t computeFingerprint(
+    const unsigned char* data,
+    const int width,
+    const int height,
+    const int channels,
+    const size_t step)
+{
+    constexpr int gridSize = 64;
+    constexpr uint64_t fnvPrime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    const auto combine = [&hash](const uint64_t value)
+    {
+        hash ^= value;
+        hash *= fnvPrime;
+    };
+
+    combine(static_cast<uint64_t>(width));
+    combine(static_cast<uint64_t>(height));
+    for (int gridRow = 0; gridRow < gridSize; gridRow++)
+    {
+        const auto* row = data + static_cast<size_t>(gridRow * height / gridSize) * step;
+        for (int gridCol = 0; gridCol < gridSize; gridCol++)
+        {
+            const auto* pixel = row + static_cast<size_t>(gridCol * width / gridSize) * channels;
+            combine(*std::max_element(pixel, pixel + std::min(channels, 3)));
+        }
+    }
+    return hash;
+}
+
+uint64_t computeFingerprint(const cv::Mat& image)
+{
+    return computeFingerprint(image.data, image.cols, image.rows, image.channels(), image.step);
+}
+
+void simulateLatency(const std::chrono::microseconds latency)
+{
+    if (latency.count() > 0)
+    {
+        std::this_thread::sleep_for(latency);
+    }
+}
+} // namespace
+
+StandInWorkerBackend::StandInWorkerBackend(const StandInOptions& options) : _options(options) {}
+
+std::string
+    StandInWorkerBackend::loadTrackingConfiguration(const std::string& trackingConfigFilepath)
+{
+    _trackingConfigFilepath = trackingConfigFilepath;
+    std::ifstream file(trackingConfigFilepath);
+    if (!file)
+    {
+        throw std::runtime_error(
+            "Could not retrieve tracking configuration file from " + trackingConfigFilepath);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+void StandInWorkerBackend::start(const std::string&) {}
+
+bool StandInWorkerBackend::isRunning()
+{
+    return _running;
+}
+
+std::string StandInWorkerBackend::execute(const std::string& cmd)
+{
+    const auto cmdJson = json::parse(cmd);
+    if (cmdJson.contains("nodeName"))
+    {
+        if (cmdJson["content"].value("name", "") == "resetHard")
+        {
+            _initPose.reset();
+            _pose.valid = false;
+        }
+        return "";
+    }
+
+    const auto name = cmdJson.value("name", "");
+    if (name == "createTracker")
+    {
+        loadTrackingResults(_trackingConfigFilepath.value_or(
+            cmdJson["param"]["uri"].get<std::string>()));
+    }
+    else if (name == "runTracking")
+    {
+        _running = true;
+    }
+    else if (name == "setInitPose")
+    {
+        _initPose = ExtrinsicDataHelpers::toExtrinsic(cmdJson["param"]);
+    }
+    else if (name == "setAttribute")
+    {
+        const auto attribute = cmdJson["param"].value("att", "");
+        const auto value = cmdJson["param"].value("val", "");
+        if (attribute == "disablePoseEstimation")
+        {
+            _poseEstimationDisabled = value == "true";
+        }
+        else if (attribute == "textureMappingConfig")
+        {
+            const auto config = json::parse(value);
+            _textureSize = {config.value("width", 1024), config.value("height", 1024)};
+        }
+    }
+    return "";
+}
+
+void StandInWorkerBackend::loadTrackingResults(const std::string& trackingConfigFilepath)
+{
+    const auto trackingResultsFilepath = _options.trackingResultsFilepath.value_or(
+        (std::filesystem::path(trackingConfigFilepath).parent_path() / "trackingResults.json")
+            .string());
+    if (!std::filesystem::exists(trackingResultsFilepath))
+    {
+        return;
+    }
+
+    const auto trackingResults = DataProcessingHelpers::loadTrackingResults(
+        std::filesystem::path(trackingResultsFilepath));
+    // "multiViewImage_0" without the index
+    auto imageNamePrefix = DataProcessingHelpers::composeImageName(0);
+    imageNamePrefix.pop_back();
+    for (const auto& [imageName, extrinsic] : trackingResults)
+    {
+        const auto frameIdx = parseIndexedKey(imageName, imageNamePrefix.c_str());
+        if (!frameIdx.has_value())
+        {
+            continue;
+        }
+        if (frameIdx.value() >= _trackingResults.size())
+        {
+            _trackingResults.resize(frameIdx.value() + 1);
+        }
+        _trackingResults[frameIdx.value()] = extrinsic;
+    }
+
+    indexFrames(_options.imageDir.value_or(
+        std::filesystem::path(trackingResultsFilepath).parent_path().string()));
+}
+
+void StandInWorkerBackend::indexFrames(const std::string& imageDir)
+{
+    _indexedImageDir = imageDir;
+    _frameIndices.clear();
+    auto frameSource = createFrameSource(imageDir);
+    for (size_t frameIdx = 0; frameIdx < frameSource->getFrameCount(); frameIdx++)
+    {
+        const auto frame = frameSource->loadFrame(frameIdx);
+        if (frame.empty())
+        {
+            continue;
+        }
+        // As injected by detectors configured for grey and for RGB images. Converting grey
+        // images to RGB does not change their fingerprint.
+        for (const auto toGrey : {true, false})
+        {
+            if (!toGrey && _inputPixelFormat == ImageHelpers::PixelFormat::Grey)
+            {
+                continue;
+            }
+            cv::Mat image;
+            try
+            {
+                image = ImageHelpers::convertImage(frame[0], _inputPixelFormat, toGrey);
+            }
+            catch (const std::runtime_error&)
+            {
+                // Not in the input pixel format, so the detector rejects this frame anyway
+                break;
+            }
+            // Identical frames keep the first index
+            _frameIndices.emplace(computeFingerprint(image), frameIdx);
+        }
+    }
+}
+
+void StandInWorkerBackend::setInputPixelFormat(const ImageHelpers::PixelFormat format)
+{
+    if (format == _inputPixelFormat)
+    {
+        return;
+    }
+    _inputPixelFormat = format;
+    if (_indexedImageDir.has_value())
+    {
+        indexFrames(_indexedImageDir.value());
+    }
+}
+
+std::optional<size_t> StandInWorkerBackend::findInjectedFrame(const Image& image)
+{
+    const auto width = static_cast<int>(vlImageWrapper_GetWidth(image.get()));
+    const auto height = static_cast<int>(vlImageWrapper_GetHeight(image.get()));
+    const auto format = vlImageWrapper_GetFormat(image.get());
+    auto channels = 4;
+    if (format == vlImageFormat::VL_IMAGE_FORMAT_GREY)
+    {
+        channels = 1;
+    }
+    else if (format == vlImageFormat::VL_IMAGE_FORMAT_RGB)
+    {
+        channels = 3;
+    }
+    const auto step = static_cast<size_t>(width) * channels;
+    // Only grows, so that tracking frames of the same size does not allocate
+    if (_injectedPixels.size() < step * height)
+    {
+        _injectedPixels.resize(step * height);
+    }
+    vlImageWrapper_CopyToBuffer(
+        image.get(), _injectedPixels.data(), static_cast<unsigned int>(step * height));
+
+    const auto frameIdx = _frameIndices.find(
+        computeFingerprint(_injectedPixels.data(), width, height, channels, step));
+    if (frameIdx == _frameIndices.end())
+    {
+        return std::nullopt;
+    }
+    return frameIdx->second;
+}
+
+CommandStatus StandInWorkerBackend::tryExecute(const char* cmd, std::string* errorMessage) noexcept
+{
+    ExtrinsicDataHelpers::Extrinsic initPose;
+    if (TrackerCommands::isResetHard(cmd))
+    {
+        _initPose.reset();
+        _pose.valid = false;
+        return CommandStatus::Ok;
+    }
+    if (TrackerCommands::parseInitPose(cmd, initPose))
+    {
+        _initPose = initPose;
+        return CommandStatus::Ok;
+    }
+    return WorkerBackend::tryExecute(cmd, errorMessage);
+}
+
+void StandInWorkerBackend::setNodeImage(
+    const Image& image,
+    const std::string&,
+    const std::string& key)
+{
+    const auto index = parseIndexedKey(key, injectImageKeyPrefix);
+    if (!index.has_value())
+    {
+        return;
+    }
+    const auto camIdx = index.value();
+    if (camIdx == 0 && !_frameIndices.empty())
+    {
+        _injectedFrameIdx = findInjectedFrame(image);
+    }
+    if (camIdx >= _injectedImageSizes.size())
+    {
+        _injectedImageSizes.resize(camIdx + 1);
+    }
+    _injectedImageSizes[camIdx] = {
+        static_cast<int>(vlImageWrapper_GetWidth(image.get())),
+        static_cast<int>(vlImageWrapper_GetHeight(image.get()))};
+    simulateLatency(_options.injectionLatencyPerImage);
+}
+
+void StandInWorkerBackend::runOnce()
+{
+    simulateLatency(_options.trackingLatency);
+
+    // Frames not found in the indexed image sequence have no pose
+    std::optional<size_t> frameIdx;
+    if (!_frameIndices.empty())
+    {
+        frameIdx = _injectedFrameIdx;
+    }
+    else if (!_trackingResults.empty())
+    {
+        frameIdx = _trackedFrameCount % _trackingResults.size();
+    }
+    _injectedFrameIdx.reset();
+    _trackedFrameCount++;
+
+    if (_initPose.has_value())
+    {
+        _pose = _initPose.value();
+    }
+    else if (
+        !_poseEstimationDisabled && frameIdx.has_value() &&
+        frameIdx.value() < _trackingResults.size() &&
+        _trackingResults[frameIdx.value()].has_value())
+    {
+        _pose = _trackingResults[frameIdx.value()].value();
+    }
+    else
+    {
+        _pose = {{0, 0, 0}, {0, 0, 0, 1}, false};
+    }
+}
+
+Image StandInWorkerBackend::getNodeImage(const std::string&, const std::string& key)
+{
+    if (const auto camIdx = parseIndexedKey(key, lineModelKeyPrefix))
+    {
+        simulateLatency(_options.readbackLatencyPerImage);
+        return ImageHelpers::toVLImageGrey(renderLineModelImage(camIdx.value()));
+    }
+    if (key.compare(0, std::strlen(textureKeyPrefix), textureKeyPrefix) == 0)
+    {
+        simulateLatency(_options.readbackLatencyPerImage);
+        return ImageHelpers::toVLImageRGB(renderTextureImage());
+    }
+    throw std::runtime_error("Stand-in backend has no image " + key);
+}
+
+ExtrinsicDataHelpers::Extrinsic
+    StandInWorkerBackend::getWorldFromAnchorTransform(const std::string&)
+{
+    return _pose;
+}
+
+void StandInWorkerBackend::post(std::function<void()> job)
+{
+    job();
+}
+
+// An outline whose position follows the pose, so that visualizations show different frames
+cv::Mat StandInWorkerBackend::renderLineModelImage(const size_t camIdx) const
+{
+    const auto size =
+        camIdx < _injectedImageSizes.size() ? _injectedImageSizes[camIdx] : cv::Size(640, 480);
+    cv::Mat image = cv::Mat::zeros(size, CV_8UC1);
+    if (!_pose.valid)
+    {
+        return image;
+    }
+
+    constexpr float pixelsPerMeter = 2000.0f;
+    const auto centerX = static_cast<int>(size.width / 2 + _pose.t[0] * pixelsPerMeter);
+    const auto centerY = static_cast<int>(size.height / 2 + _pose.t[1] * pixelsPerMeter);
+    const auto halfExtent = std::max(4, std::min(size.width, size.height) / 8);
+    cv::rectangle(
+        image,
+        cv::Point(centerX - halfExtent, centerY - halfExtent),
+        cv::Point(centerX + halfExtent, centerY + halfExtent),
+        cv::Scalar(255),
+        2);
+    return image;
+}
+
+cv::Mat StandInWorkerBackend::renderTextureImage() const
+{
+    cv::Mat texture(_textureSize.height, _textureSize.width, CV_8UC3);
+    for (int row = 0; row < texture.rows; row++)
+    {
+        auto* texelRow = texture.ptr<cv::Vec3b>(row);
+        for (int col = 0; col < texture.cols; col++)
+        {
+            texelRow[col][0] = static_cast<unsigned char>(col * 255 / texture.cols);
+            texelRow[col][1] = static_cast<unsigned char>(row * 255 / texture.rows);
+            texelRow[col][2] = static_cast<unsigned char>(_trackedFrameCount * 32);
+        }
+    }
+    return texture;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Backends/WorkerBackend.h>
+
+#include <opencv2/core.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct StandInOptions
+{
+    // Defaults to trackingResults.json next to the tracking configuration
+    std::optional<std::string> trackingResultsFilepath;
+    // The image sequence the poses belong to (see createFrameSource()). Injected frames are
+    // recognized by the content of their first image, so that the pose of multiViewImage_<N> is
+    // returned for frame N regardless of the order in which frames are tracked. The images are
+    // converted like the detector converts them, see setInputPixelFormat(). Without frames in
+    // this directory, poses are returned in tracking order, starting over after the last one.
+    // Defaults to the directory of the tracking results.
+    std::optional<std::string> imageDir;
+    std::chrono::microseconds trackingLatency {0};
+    std::chrono::microseconds injectionLatencyPerImage {0};
+    std::chrono::microseconds readbackLatencyPerImage {0};
+};
+
+// Stands in for the vlSDK worker without a license or a native tracker, so that the pipeline
+// around MultiViewDetector can be benchmarked on any machine. It interprets the commands sent by
+// MultiViewDetector, returns the poses of a tracking results file, renders synthetic line model
+// and texture images and simulates the configured latencies.
+class StandInWorkerBackend : public WorkerBackend
+{
+public:
+    explicit StandInWorkerBackend(const StandInOptions& options = StandInOptions());
+
+    std::string loadTrackingConfiguration(const std::string& trackingConfigFilepath) override;
+
+    std::string execute(const std::string& cmd) override;
+    CommandStatus tryExecute(const char* cmd, std::string* errorMessage) noexcept override;
+    void setNodeImage(const Image& image, const std::string& nodeName, const std::string& key)
+        override;
+    void runOnce() override;
+
+    Image getNodeImage(const std::string& nodeName, const std::string& key) override;
+    ExtrinsicDataHelpers::Extrinsic
+        getWorldFromAnchorTransform(const std::string& anchorName) override;
+
+    // Indexes the image sequence again if the tracking configuration is loaded already
+    void setInputPixelFormat(const ImageHelpers::PixelFormat format) override;
+
+    void post(std::function<void()> job) override;
+
+protected:
+    void start(const std::string& licenseFilepath) override;
+    bool isRunning() override;
+
+private:
+    void loadTrackingResults(const std::string& trackingConfigFilepath);
+    void indexFrames(const std::string& imageDir);
+    std::optional<size_t> findInjectedFrame(const Image& image);
+    cv::Mat renderLineModelImage(const size_t camIdx) const;
+    cv::Mat renderTextureImage() const;
+
+    StandInOptions _options;
+    // The configuration loaded by the detector, since the tracker may be created from a copy in
+    // the InitStateCache directory
+    std::optional<std::string> _trackingConfigFilepath;
+    bool _running = false;
+    bool _poseEstimationDisabled = false;
+    cv::Size _textureSize = {1024, 1024};
+    // Indexed by frame, so that tracking does not need to compose image names
+    std::vector<std::optional<ExtrinsicDataHelpers::Extrinsic>> _trackingResults;
+    ImageHelpers::PixelFormat _inputPixelFormat = ImageHelpers::PixelFormat::Grey;
+    std::optional<std::string> _indexedImageDir;
+    // Frame index by fingerprint of the first image of the frame, as injected
+    std::unordered_map<uint64_t, size_t> _frameIndices;
+    // Reused to read the first injected image
+    std::vector<unsigned char> _injectedPixels;
+    std::optional<size_t> _injectedFrameIdx;
+    std::vector<cv::Size> _injectedImageSizes;
+    std::optional<ExtrinsicDataHelpers::Extrinsic> _initPose;
+    ExtrinsicDataHelpers::Extrinsic _pose = {{0, 0, 0}, {0, 0, 0, 1}, false};
+    size_t _trackedFrameCount = 0;
+};
@@ -0,0 +1,90 @@
+#include <Backends/SyncWorkerBackend.h>
+
+#include <nlohmann/json.hpp>
+#include <vlSDK.h>
+
+#include <stdexcept>
+#include <utility>
+
+using namespace nlohmann;
+
+SyncWorkerBackend::SyncWorkerBackend() : _worker(vlNew_SyncWorker()) {}
+
+void SyncWorkerBackend::start(const std::string& licenseFilepath)
+{
+    if (!vlWorker_Start(_worker.get()))
+    {
+        throw std::runtime_error("vlWorker_Start returned false.");
+    }
+    if (!vlWorker_SetLicenseFilePath(_worker.get(), licenseFilepath.c_str()))
+    {
+        throw std::runtime_error("Could not set License");
+    }
+}
+
+bool SyncWorkerBackend::isRunning()
+{
+    return vlWorker_IsRunning(_worker.get());
+}
+
+std::string SyncWorkerBackend::execute(const std::string& cmd)
+{
+    using StringPair = std::pair<std::string, std::string>;
+    StringPair result;
+    if (!vlWorker_ProcessJsonCommandSync(
+            _worker.get(),
+            cmd.c_str(),
+            [](const char* error, const char* data, void* clientData)
+            {
+                auto& result = *reinterpret_cast<StringPair*>(clientData);
+                result.first = error ? error : "";
+                result.second = data ? data : "";
+            },
+            &result))
+    {
+        throw std::runtime_error(
+            "Command " + cmd + " could not be processed. Invalid JSON or unsupported command.");
+    }
+    if (!result.first.empty())
+    {
+        const auto resultJson = json::parse(result.first);
+        throw std::runtime_error(resultJson["message"].get<std::string>());
+    }
+    return result.second;
+}
+
+CommandStatus SyncWorkerBackend::tryExecute(const char* cmd, std::string* errorMessage) noexcept
+{
+    return tryProcessCommand(_worker.get(), cmd, errorMessage);
+}
+
+void SyncWorkerBackend::setNodeImage(
+    const Image& image,
+    const std::string& nodeName,
+    const std::string& key)
+{
+    vlWorker_SetNodeImageSync(_worker.get(), image.get(), nodeName.c_str(), key.c_str());
+}
+
+void SyncWorkerBackend::runOnce()
+{
+    vlWorker_RunOnceSync(_worker.get());
+}
+
+Image SyncWorkerBackend::getNodeImage(const std::string& nodeName, const std::string& key)
+{
+    return Image(vlWorker_GetNodeImageSync(_worker.get(), nodeName.c_str(), key.c_str()));
+}
+
+ExtrinsicDataHelpers::Extrinsic
+    SyncWorkerBackend::getWorldFromAnchorTransform(const std::string& anchorName)
+{
+    SimilarityTransform worldFromAnchorTransform(
+        vlWorker_GetWorldFromAnchorTransform(_worker.get(), anchorName.c_str()));
+    return ExtrinsicDataHelpers::toExtrinsic(worldFromAnchorTransform.get());
+}
+
+void SyncWorkerBackend::post(std::function<void()> job)
+{
+    job();
+}
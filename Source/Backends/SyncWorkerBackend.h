@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Backends/WorkerBackend.h>
+
+// Processes every call on the calling thread with a worker created by vlNew_SyncWorker.
+class SyncWorkerBackend : public WorkerBackend
+{
+public:
+    SyncWorkerBackend();
+
+    std::string execute(const std::string& cmd) override;
+    CommandStatus tryExecute(const char* cmd, std::string* errorMessage) noexcept override;
+    void setNodeImage(const Image& image, const std::string& nodeName, const std::string& key)
+        override;
+    void runOnce() override;
+
+    Image getNodeImage(const std::string& nodeName, const std::string& key) override;
+    ExtrinsicDataHelpers::Extrinsic
+        getWorldFromAnchorTransform(const std::string& anchorName) override;
+
+    void post(std::function<void()> job) override;
+
+protected:
+    void start(const std::string& licenseFilepath) override;
+    bool isRunning() override;
+
+private:
+    Worker _worker;
+};
@@ -0,0 +1,207 @@
+#include <Backends/ThreadedWorkerBackend.h>
+
+#include <Metrics/MetricsRegistry.h>
+
+#include <nlohmann/json.hpp>
+#include <vlSDK.h>
+
+#include <future>
+#include <iostream>
+#include <stdexcept>
+
+using namespace nlohmann;
+
+namespace
+{
+Metrics::Gauge& getQueueDepthGauge()
+{
+    static auto& queueDepth = Metrics::Registry::global().gauge(
+        "vldemo_worker_queue_depth", "Jobs queued on threaded workers");
+    return queueDepth;
+}
+
+struct CommandResult
+{
+    std::string error;
+    std::string data;
+};
+} // namespace
+
+ThreadedWorkerBackend::ThreadedWorkerBackend() :
+    _worker(vlNew_SyncWorker()), _dispatcher(&ThreadedWorkerBackend::dispatchLoop, this)
+{
+}
+
+ThreadedWorkerBackend::~ThreadedWorkerBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobsMutex);
+        _stopping = true;
+    }
+    _jobsAvailable.notify_one();
+    _dispatcher.join();
+    getQueueDepthGauge().add(-static_cast<double>(_jobs.size()));
+}
+
+template<typename Fn>
+auto ThreadedWorkerBackend::invoke(Fn fn) -> decltype(fn())
+{
+    if (std::this_thread::get_id() == _dispatcher.get_id())
+    {
+        return fn();
+    }
+    auto task = std::make_shared<std::packaged_task<decltype(fn())()>>(std::move(fn));
+    auto result = task->get_future();
+    post([task]() { (*task)(); });
+    return result.get();
+}
+
+void ThreadedWorkerBackend::dispatchLoop()
+{
+    std::unique_lock<std::mutex> lock(_jobsMutex);
+    while (true)
+    {
+        _jobsAvailable.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+        if (_jobs.empty())
+        {
+            return;
+        }
+
+        auto job = std::move(_jobs.front());
+        _jobs.pop_front();
+        getQueueDepthGauge().add(-1);
+        lock.unlock();
+        try
+        {
+            job();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Unhandled exception in worker job: " << e.what() << "\n";
+        }
+        catch (...)
+        {
+            // Jobs report their own failures through their promise, see post()
+            std::cerr << "Unhandled exception in worker job\n";
+        }
+        lock.lock();
+    }
+}
+
+bool ThreadedWorkerBackend::hasDispatcherThread() const
+{
+    return true;
+}
+
+void ThreadedWorkerBackend::post(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_jobsMutex);
+        _jobs.push_back(std::move(job));
+        getQueueDepthGauge().add(1);
+    }
+    _jobsAvailable.notify_one();
+}
+
+void ThreadedWorkerBackend::start(const std::string& licenseFilepath)
+{
+    invoke(
+        [this, &licenseFilepath]()
+        {
+            if (!vlWorker_Start(_worker.get()))
+            {
+                throw std::runtime_error("vlWorker_Start returned false.");
+            }
+            if (!vlWorker_SetLicenseFilePath(_worker.get(), licenseFilepath.c_str()))
+            {
+                throw std::runtime_error("Could not set License");
+            }
+        });
+}
+
+bool ThreadedWorkerBackend::isRunning()
+{
+    return invoke([this]() { return static_cast<bool>(vlWorker_IsRunning(_worker.get())); });
+}
+
+std::string ThreadedWorkerBackend::execute(const std::string& cmd)
+{
+    return invoke(
+        [this, &cmd]()
+        {
+            CommandResult result;
+            if (!vlWorker_ProcessJsonCommandSync(
+                    _worker.get(),
+                    cmd.c_str(),
+                    [](const char* error, const char* data, void* clientData)
+                    {
+                        auto& result = *reinterpret_cast<CommandResult*>(clientData);
+                        result.error = error ? error : "";
+                        result.data = data ? data : "";
+                    },
+                    &result))
+            {
+                throw std::runtime_error(
+                    "Command " + cmd +
+                    " could not be processed. Invalid JSON or unsupported command.");
+            }
+            if (!result.error.empty())
+            {
+                const auto resultJson = json::parse(result.error);
+                throw std::runtime_error(resultJson["message"].get<std::string>());
+            }
+            return result.data;
+        });
+}
+
+CommandStatus ThreadedWorkerBackend::tryExecute(
+    const char* cmd,
+    std::string* errorMessage) noexcept
+{
+    try
+    {
+        // Only free of allocations when called by a job on the dispatcher thread
+        return invoke([this, cmd, errorMessage]()
+                      { return tryProcessCommand(_worker.get(), cmd, errorMessage); });
+    }
+    catch (...)
+    {
+        return CommandStatus::Failed;
+    }
+}
+
+void ThreadedWorkerBackend::setNodeImage(
+    const Image& image,
+    const std::string& nodeName,
+    const std::string& key)
+{
+    invoke(
+        [this, &image, &nodeName, &key]()
+        {
+            vlWorker_SetNodeImageSync(_worker.get(), image.get(), nodeName.c_str(), key.c_str());
+        });
+}
+
+void ThreadedWorkerBackend::runOnce()
+{
+    invoke([this]() { vlWorker_RunOnceSync(_worker.get()); });
+}
+
+Image ThreadedWorkerBackend::getNodeImage(const std::string& nodeName, const std::string& key)
+{
+    return invoke(
+        [this, &nodeName, &key]()
+        { return Image(vlWorker_GetNodeImageSync(_worker.get(), nodeName.c_str(), key.c_str())); });
+}
+
+ExtrinsicDataHelpers::Extrinsic
+    ThreadedWorkerBackend::getWorldFromAnchorTransform(const std::string& anchorName)
+{
+    return invoke(
+        [this, &anchorName]()
+        {
+            SimilarityTransform worldFromAnchorTransform(
+                vlWorker_GetWorldFromAnchorTransform(_worker.get(), anchorName.c_str()));
+            return ExtrinsicDataHelpers::toExtrinsic(worldFromAnchorTransform.get());
+        });
+}
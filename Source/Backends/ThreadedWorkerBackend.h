@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Backends/WorkerBackend.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Drives a synchronous worker (vlNew_SyncWorker) from a dedicated dispatcher thread. All calls
+// are queued and processed in order, so callers do not block while a frame is tracked and can
+// convert the next frame in the meantime. Injecting and tracking themselves stay sequential.
+class ThreadedWorkerBackend : public WorkerBackend
+{
+public:
+    ThreadedWorkerBackend();
+    ~ThreadedWorkerBackend() override;
+
+    std::string execute(const std::string& cmd) override;
+    CommandStatus tryExecute(const char* cmd, std::string* errorMessage) noexcept override;
+    void setNodeImage(const Image& image, const std::string& nodeName, const std::string& key)
+        override;
+    void runOnce() override;
+
+    Image getNodeImage(const std::string& nodeName, const std::string& key) override;
+    ExtrinsicDataHelpers::Extrinsic
+        getWorldFromAnchorTransform(const std::string& anchorName) override;
+
+    void post(std::function<void()> job) override;
+    bool hasDispatcherThread() const override;
+
+protected:
+    void start(const std::string& licenseFilepath) override;
+    bool isRunning() override;
+
+private:
+    // Runs fn on the dispatcher thread and blocks until it has finished
+    template<typename Fn>
+    auto invoke(Fn fn) -> decltype(fn());
+    void dispatchLoop();
+
+    Worker _worker;
+    std::mutex _jobsMutex;
+    std::condition_variable _jobsAvailable;
+    std::deque<std::function<void()>> _jobs;
+    bool _stopping = false;
+    std::thread _dispatcher;
+};
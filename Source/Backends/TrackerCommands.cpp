@@ -0,0 +1,149 @@
+#include <Backends/TrackerCommands.h>
+
+#include <nlohmann/json.hpp>
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+using namespace nlohmann;
+
+namespace
+{
+void append(char*& pos, char* end, const char* text)
+{
+    const auto length = std::strlen(text);
+    if (static_cast<size_t>(end - pos) < length)
+    {
+        throw std::length_error("Command buffer too small");
+    }
+    std::memcpy(pos, text, length);
+    pos += length;
+}
+
+template<size_t size>
+void appendArray(char*& pos, char* end, const std::array<float, size>& values)
+{
+    append(pos, end, "[");
+    for (size_t i = 0; i < size; i++)
+    {
+        if (i > 0)
+        {
+            append(pos, end, ",");
+        }
+        // Locale independent and as short as possible while round-tripping
+        const auto result = std::to_chars(pos, end, values[i]);
+        if (result.ec != std::errc())
+        {
+            throw std::length_error("Command buffer too small");
+        }
+        pos = result.ptr;
+    }
+    append(pos, end, "]");
+}
+
+template<size_t size>
+bool parseArray(const char* cmd, const char* key, std::array<float, size>& values)
+{
+    const auto* pos = std::strstr(cmd, key);
+    if (!pos)
+    {
+        return false;
+    }
+    pos = std::strchr(pos + std::strlen(key), '[');
+    if (!pos)
+    {
+        return false;
+    }
+    const auto* end = pos + std::strlen(pos);
+    for (size_t i = 0; i < size; i++)
+    {
+        pos++; // '[' or ','
+        while (pos < end && *pos == ' ')
+        {
+            pos++;
+        }
+        const auto result = std::from_chars(pos, end, values[i]);
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+        pos = result.ptr;
+    }
+    return *pos == ']';
+}
+} // namespace
+
+namespace TrackerCommands
+{
+std::string createTracker(const std::string& trackerPath)
+{
+    json cmd;
+    cmd["name"] = "createTracker";
+    cmd["param"]["uri"] = trackerPath;
+    return cmd.dump();
+}
+
+std::string runTracking()
+{
+    json cmd;
+    cmd["name"] = "runTracking";
+    return cmd.dump();
+}
+
+std::string resetHard(const std::string& trackerName)
+{
+    json cmd;
+    cmd["nodeName"] = trackerName;
+    cmd["content"]["name"] = "resetHard";
+    return cmd.dump();
+}
+
+std::string setAttribute(const std::string& attributeName, const std::string& value)
+{
+    json cmd;
+    cmd["name"] = "setAttribute";
+    cmd["param"]["att"] = attributeName;
+    cmd["param"]["val"] = value;
+    return cmd.dump();
+}
+
+const char* InitPoseCommand::format(const ExtrinsicDataHelpers::Extrinsic& extrinsic)
+{
+    auto* pos = _buffer.data();
+    // Keep room for the terminating null character
+    auto* end = _buffer.data() + _buffer.size() - 1;
+    append(pos, end, R"({"name":"setInitPose","param":{"r":)");
+    appendArray(pos, end, extrinsic.q);
+    append(pos, end, R"(,"t":)");
+    appendArray(pos, end, extrinsic.t);
+    append(pos, end, "}}");
+    *pos = '\0';
+    return _buffer.data();
+}
+
+bool isResetHard(const char* cmd)
+{
+    return std::strstr(cmd, R"("resetHard")") != nullptr;
+}
+
+bool parseInitPose(const char* cmd, ExtrinsicDataHelpers::Extrinsic& extrinsic)
+{
+    if (!std::strstr(cmd, R"("setInitPose")"))
+    {
+        return false;
+    }
+    extrinsic.valid = true;
+    return parseArray(cmd, R"("t":)", extrinsic.t) && parseArray(cmd, R"("r":)", extrinsic.q);
+}
+
+std::string parseErrorMessage(const std::string& error)
+{
+    const auto errorJson = json::parse(error, nullptr, false);
+    if (errorJson.is_object() && errorJson.contains("message") && errorJson["message"].is_string())
+    {
+        return errorJson["message"].get<std::string>();
+    }
+    return error;
+}
+} // namespace TrackerCommands
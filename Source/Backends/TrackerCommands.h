@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Helpers/ExtrinsicDataHelpers.h>
+
+#include <array>
+#include <string>
+
+// Builders for the JSON commands sent to the worker. Commands which are sent for every frame
+// are either built once or formatted into a reused buffer, so that they do not allocate.
+namespace TrackerCommands
+{
+std::string createTracker(const std::string& trackerPath);
+std::string runTracking();
+std::string resetHard(const std::string& trackerName);
+std::string setAttribute(const std::string& attributeName, const std::string& value);
+
+class InitPoseCommand
+{
+public:
+    // The returned command is valid until the next call
+    const char* format(const ExtrinsicDataHelpers::Extrinsic& extrinsic);
+
+private:
+    std::array<char, 256> _buffer = {};
+};
+
+// Recognize the commands above without parsing them into a JSON object
+bool isResetHard(const char* cmd);
+bool parseInitPose(const char* cmd, ExtrinsicDataHelpers::Extrinsic& extrinsic);
+
+// The message of an error reported by the worker, or the whole error if it has none
+std::string parseErrorMessage(const std::string& error);
+} // namespace TrackerCommands
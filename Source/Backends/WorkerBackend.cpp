@@ -0,0 +1,159 @@
+#include <Backends/WorkerBackend.h>
+
+#include <Backends/ThreadedWorkerBackend.h>
+#include <Backends/StandInWorkerBackend.h>
+#include <Backends/SyncWorkerBackend.h>
+#include <Backends/TrackerCommands.h>
+
+#include <stdexcept>
+#include <utility>
+
+std::string to_string(const WorkerBackendType type)
+{
+    switch (type)
+    {
+        case WorkerBackendType::Sync:
+            return "Sync";
+        case WorkerBackendType::Threaded:
+            return "Threaded";
+        case WorkerBackendType::StandIn:
+            return "StandIn";
+        default:
+            throw std::runtime_error("Unknown worker backend type");
+    }
+}
+
+std::string WorkerBackend::loadTrackingConfiguration(const std::string& trackingConfigFilepath)
+{
+    unsigned long resultLength;
+    auto resultPtr = ByteBuffer(vlSDKUtil_get(trackingConfigFilepath.c_str(), &resultLength));
+    if (!resultPtr)
+    {
+        throw std::runtime_error(
+            "Could not retrieve tracking configuration file from " + trackingConfigFilepath);
+    }
+    return std::string(resultPtr.get());
+}
+
+CommandStatus WorkerBackend::tryExecute(const char* cmd, std::string* errorMessage) noexcept
+{
+    try
+    {
+        execute(cmd);
+        return CommandStatus::Ok;
+    }
+    catch (const std::exception& e)
+    {
+        if (errorMessage)
+        {
+            try
+            {
+                *errorMessage = e.what();
+            }
+            catch (...)
+            {
+            }
+        }
+        return CommandStatus::Failed;
+    }
+    catch (...)
+    {
+        return CommandStatus::Failed;
+    }
+}
+
+bool WorkerBackend::hasDispatcherThread() const
+{
+    return false;
+}
+
+CommandStatus WorkerBackend::tryProcessCommand(
+    vlWorker_t* worker,
+    const char* cmd,
+    std::string* errorMessage) noexcept
+{
+    // The error is only copied if it is asked for, and parsed after returning from the worker
+    using Failure = std::pair<bool, std::string*>;
+    Failure failure(false, errorMessage);
+    if (!vlWorker_ProcessJsonCommandSync(
+            worker,
+            cmd,
+            [](const char* error, const char*, void* clientData)
+            {
+                auto& failure = *reinterpret_cast<Failure*>(clientData);
+                failure.first = error && *error;
+                if (failure.first && failure.second)
+                {
+                    try
+                    {
+                        *failure.second = error;
+                    }
+                    catch (...)
+                    {
+                        failure.second = nullptr;
+                    }
+                }
+            },
+            &failure))
+    {
+        return CommandStatus::Rejected;
+    }
+    if (!failure.first)
+    {
+        return CommandStatus::Ok;
+    }
+    if (failure.second)
+    {
+        try
+        {
+            *failure.second = TrackerCommands::parseErrorMessage(*failure.second);
+        }
+        catch (...)
+        {
+        }
+    }
+    return CommandStatus::Failed;
+}
+
+void WorkerBackend::startTracking(
+    const std::string& licenseFilepath,
+    const std::string& trackingConfigFilepath)
+{
+    start(licenseFilepath);
+
+    try
+    {
+        execute(TrackerCommands::createTracker(trackingConfigFilepath));
+    }
+    catch (std::runtime_error& e)
+    {
+        throw std::runtime_error("Could not create tracker: " + std::string(e.what()));
+    }
+    try
+    {
+        execute(TrackerCommands::runTracking());
+    }
+    catch (std::runtime_error& e)
+    {
+        throw std::runtime_error("Could not enable tracking: " + std::string(e.what()));
+    }
+    if (!isRunning())
+    {
+        throw std::runtime_error("Tracker is not Running");
+    }
+}
+
+std::unique_ptr<WorkerBackend> createWorkerBackend(const WorkerBackendType type)
+{
+    switch (type)
+    {
+        case WorkerBackendType::Sync:
+            return std::make_unique<SyncWorkerBackend>();
+        case WorkerBackendType::Threaded:
+            return std::make_unique<ThreadedWorkerBackend>();
+        case WorkerBackendType::StandIn:
+            return std::make_unique<StandInWorkerBackend>();
+        default:
+            throw std::runtime_error("Unknown worker backend type");
+    }
+}
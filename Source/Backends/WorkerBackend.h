@@ -0,0 +1,80 @@
+#pragma once
+
+#include <Helpers/ExtrinsicDataHelpers.h>
+#include <Helpers/ImageHelpers.h>
+#include <Helpers/PointerHandler.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+enum class WorkerBackendType
+{
+    Sync,
+    Threaded,
+    // Runs without license and vlSDK worker, see StandInWorkerBackend
+    StandIn
+};
+
+std::string to_string(const WorkerBackendType type);
+
+enum class CommandStatus
+{
+    Ok,
+    // Invalid JSON or unsupported command
+    Rejected,
+    Failed
+};
+
+// Wraps the vlSDK worker, so that MultiViewDetector does not depend on whether commands are
+// processed on the calling thread or on a dispatcher thread, or by a stand-in without any worker
+// at all.
+class WorkerBackend
+{
+public:
+    virtual ~WorkerBackend() = default;
+
+    // Creates the tracker from the tracking configuration and starts tracking
+    void startTracking(
+        const std::string& licenseFilepath,
+        const std::string& trackingConfigFilepath);
+
+    // Returns the content of the tracking configuration. Uses vlSDKUtil_get by default, which
+    // also resolves VisionLib URI schemes.
+    virtual std::string loadTrackingConfiguration(const std::string& trackingConfigFilepath);
+
+    virtual std::string execute(const std::string& cmd) = 0;
+    // For the per-frame commands: neither allocates nor throws, and ignores the command's result.
+    // If the command fails, the tracker's message is stored in errorMessage unless it is null,
+    // which is the only case that allocates. The default implementation falls back to execute().
+    virtual CommandStatus tryExecute(const char* cmd, std::string* errorMessage) noexcept;
+    virtual void
+        setNodeImage(const Image& image, const std::string& nodeName, const std::string& key) = 0;
+    virtual void runOnce() = 0;
+
+    virtual Image getNodeImage(const std::string& nodeName, const std::string& key) = 0;
+    virtual ExtrinsicDataHelpers::Extrinsic
+        getWorldFromAnchorTransform(const std::string& anchorName) = 0;
+
+    // The layout of the camera images before their conversion for injection, see
+    // MultiViewDetector::setInputPixelFormat(). Ignored unless the backend inspects the images.
+    virtual void setInputPixelFormat(const ImageHelpers::PixelFormat /*format*/) {}
+
+    // Runs the job in order with all other calls to this backend. The synchronous backend runs
+    // it right away on the calling thread. Jobs have to pass their exceptions on themselves,
+    // e.g. to a promise, since there is no caller to rethrow them to.
+    virtual void post(std::function<void()> job) = 0;
+    // Whether the calls are processed on a thread of the backend instead of the calling thread
+    virtual bool hasDispatcherThread() const;
+
+protected:
+    virtual void start(const std::string& licenseFilepath) = 0;
+    virtual bool isRunning() = 0;
+
+    // tryExecute() for backends with a vlSDK worker processing commands synchronously
+    static CommandStatus
+        tryProcessCommand(vlWorker_t* worker, const char* cmd, std::string* errorMessage) noexcept;
+};
+
+// The backend is not started yet, see startTracking()
+std::unique_ptr<WorkerBackend> createWorkerBackend(const WorkerBackendType type);
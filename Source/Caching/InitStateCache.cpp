@@ -0,0 +1,345 @@
+#include <Caching/InitStateCache.h>
+
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+using namespace nlohmann;
+
+namespace
+{
+constexpr uint64_t fnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t fnvPrime = 1099511628211ull;
+constexpr auto projectDirScheme = "project-dir:";
+constexpr auto cachedConfigFilename = "trackingConfig.vl";
+constexpr auto autoInitCacheDirname = "autoInit";
+// Written once the data of a key has been learned completely
+constexpr auto completeMarkerFilename = "complete";
+
+void hashBytes(uint64_t& hash, const char* data, const size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnvPrime;
+    }
+}
+
+void hashFile(uint64_t& hash, const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot read model file " + path.string());
+    }
+    std::array<char, 1 << 16> buffer;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+    {
+        hashBytes(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+}
+
+// Model references are relative to the configuration ("project-dir:") or plain file paths
+void collectModelFiles(
+    const json& node,
+    const std::filesystem::path& projectDir,
+    std::map<std::string, std::filesystem::path>& modelFiles)
+{
+    if (node.is_object())
+    {
+        for (const auto& [key, value] : node.items())
+        {
+            if ((key == "uri" || key == "modelURI") && value.is_string())
+            {
+                auto uri = value.get<std::string>();
+                if (uri.rfind(projectDirScheme, 0) == 0)
+                {
+                    uri = (projectDir / uri.substr(std::string(projectDirScheme).size())).string();
+                }
+                if (std::filesystem::exists(uri))
+                {
+                    modelFiles[uri] = uri;
+                }
+            }
+            else
+            {
+                collectModelFiles(value, projectDir, modelFiles);
+            }
+        }
+    }
+    else if (node.is_array())
+    {
+        for (const auto& element : node)
+        {
+            collectModelFiles(element, projectDir, modelFiles);
+        }
+    }
+}
+// The caching copy lives in the cache directory, so references relative to the original
+// configuration are made absolute
+void resolveProjectDir(json& node, const std::filesystem::path& projectDir)
+{
+    if (node.is_string())
+    {
+        const auto value = node.get<std::string>();
+        if (value.rfind(projectDirScheme, 0) == 0)
+        {
+            node = (projectDir / value.substr(std::string(projectDirScheme).size())).string();
+        }
+    }
+    else if (node.is_object() || node.is_array())
+    {
+        for (auto& element : node)
+        {
+            resolveProjectDir(element, projectDir);
+        }
+    }
+}
+
+// Only where AutoInit is configured, so that it is not enabled for further anchors
+void enableAutoInitCache(json& trackerParameters, const std::filesystem::path& autoInitCacheDir)
+{
+    if (!trackerParameters.is_object() || !trackerParameters.contains("autoInit"))
+    {
+        return;
+    }
+    auto& autoInit = trackerParameters["autoInit"];
+    autoInit["cacheResults"] = true;
+    autoInit["cacheURI"] = autoInitCacheDir.string();
+}
+
+void writeCachingConfiguration(
+    const std::string& trackingConfigFilepath,
+    json trackingConfig,
+    const std::filesystem::path& entryDir)
+{
+    resolveProjectDir(
+        trackingConfig, std::filesystem::absolute(trackingConfigFilepath).parent_path());
+    const auto autoInitCacheDir = std::filesystem::absolute(entryDir / autoInitCacheDirname);
+    auto& trackerParameters = trackingConfig["tracker"]["parameters"];
+    if (trackerParameters.contains("anchors"))
+    {
+        for (auto& anchor : trackerParameters["anchors"])
+        {
+            if (anchor.contains("parameters"))
+            {
+                enableAutoInitCache(anchor["parameters"], autoInitCacheDir);
+            }
+        }
+    }
+    else
+    {
+        enableAutoInitCache(trackerParameters, autoInitCacheDir);
+    }
+
+    std::filesystem::create_directories(autoInitCacheDir);
+    std::ofstream file(entryDir / cachedConfigFilename);
+    file << trackingConfig.dump(2);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write " + (entryDir / cachedConfigFilename).string());
+    }
+}
+// An exclusive lock on a file, which serializes learning an entry across processes. The operating
+// system releases it if the process dies.
+class FileLock
+{
+public:
+    explicit FileLock(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        _file = CreateFileW(
+            path.c_str(),
+            GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr,
+            OPEN_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr);
+        OVERLAPPED overlapped{};
+        if (_file == INVALID_HANDLE_VALUE ||
+            !LockFileEx(_file, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped))
+        {
+            if (_file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(_file);
+            }
+            throw std::runtime_error("Cannot lock " + path.string());
+        }
+#else
+        _file = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        auto result = _file < 0 ? -1 : flock(_file, LOCK_EX);
+        while (result != 0 && errno == EINTR)
+        {
+            result = flock(_file, LOCK_EX);
+        }
+        if (result != 0)
+        {
+            if (_file >= 0)
+            {
+                close(_file);
+            }
+            throw std::runtime_error("Cannot lock " + path.string());
+        }
+#endif
+    }
+
+    ~FileLock()
+    {
+#ifdef _WIN32
+        OVERLAPPED overlapped{};
+        UnlockFileEx(_file, 0, MAXDWORD, MAXDWORD, &overlapped);
+        CloseHandle(_file);
+#else
+        flock(_file, LOCK_UN);
+        close(_file);
+#endif
+    }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+#ifdef _WIN32
+    HANDLE _file;
+#else
+    int _file;
+#endif
+};
+} // namespace
+
+InitStateCache& InitStateCache::global()
+{
+    static InitStateCache cache;
+    return cache;
+}
+
+void InitStateCache::setDirectory(const std::optional<std::filesystem::path>& cacheDir)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cacheDir = cacheDir;
+    _entries.clear();
+}
+
+bool InitStateCache::isEnabled() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _cacheDir.has_value();
+}
+
+std::string InitStateCache::computeKey(
+    const std::string& trackingConfigFilepath,
+    const json& trackingConfig)
+{
+    auto hash = fnvOffsetBasis;
+    const auto config = trackingConfig.dump();
+    hashBytes(hash, config.data(), config.size());
+
+    // Sorted by path, so that the key does not depend on the order within the configuration
+    std::map<std::string, std::filesystem::path> modelFiles;
+    collectModelFiles(
+        trackingConfig,
+        std::filesystem::absolute(trackingConfigFilepath).parent_path(),
+        modelFiles);
+    for (const auto& [name, path] : modelFiles)
+    {
+        hashFile(hash, path);
+    }
+
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+InitStateCache::Source InitStateCache::createTracker(
+    const std::string& trackingConfigFilepath,
+    const json& trackingConfig,
+    const CreateFn& createFn)
+{
+    const auto key = computeKey(trackingConfigFilepath, trackingConfig);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_cacheDir.has_value())
+    {
+        throw std::runtime_error("Init state cache has no directory");
+    }
+    const auto entryDir = composeEntryPath(key);
+    const auto cachedConfigFilepath = entryDir / cachedConfigFilename;
+    const auto entry = _entries.find(key);
+    if (entry != _entries.end())
+    {
+        // Waits without the lock, in case the data is still being learned
+        auto learned = entry->second;
+        lock.unlock();
+        learned.get();
+        createFn(cachedConfigFilepath);
+        return Source::Memory;
+    }
+
+    std::promise<void> promise;
+    _entries[key] = promise.get_future().share();
+    if (std::filesystem::exists(entryDir / completeMarkerFilename))
+    {
+        promise.set_value();
+        lock.unlock();
+        createFn(cachedConfigFilepath);
+        return Source::Disk;
+    }
+    lock.unlock();
+
+    // Other processes using the same directory may be learning the same entry
+    auto learnedByOtherProcess = false;
+    try
+    {
+        std::filesystem::create_directories(entryDir.parent_path());
+        auto lockFilepath = entryDir;
+        lockFilepath += ".lock";
+        FileLock entryLock(lockFilepath);
+        learnedByOtherProcess = std::filesystem::exists(entryDir / completeMarkerFilename);
+        if (!learnedByOtherProcess)
+        {
+            // Starts over if a previous run was interrupted while learning
+            std::filesystem::remove_all(entryDir);
+            writeCachingConfiguration(trackingConfigFilepath, trackingConfig, entryDir);
+            createFn(cachedConfigFilepath);
+            std::ofstream marker(entryDir / completeMarkerFilename);
+            marker << key << "\n";
+            if (!marker)
+            {
+                throw std::runtime_error("Cannot mark " + entryDir.string() + " as complete");
+            }
+        }
+    }
+    catch (...)
+    {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        _entries.erase(key);
+        throw;
+    }
+    promise.set_value();
+
+    if (learnedByOtherProcess)
+    {
+        createFn(cachedConfigFilepath);
+        return Source::Disk;
+    }
+    return Source::Built;
+}
+
+std::filesystem::path InitStateCache::composeEntryPath(const std::string& key) const
+{
+    return _cacheDir.value() / ("initState_v" + std::to_string(formatVersion) + "_" + key);
+}
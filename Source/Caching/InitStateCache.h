@@ -0,0 +1,65 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+// Lets AutoInit cache the initialization data it learns from the models and the workspace
+// definition, keyed by a hash of the tracking configuration and the model files. For each key the
+// cache directory holds a copy of the tracking configuration with "autoInit.cacheResults" enabled
+// and the AutoInit cache pointing into the directory of the key, for the autoInit blocks the
+// configuration already has. Trackers created from this copy
+// by later runs, or concurrently in the same process, load the learned data instead of learning
+// it again.
+class InitStateCache
+{
+public:
+    // Increase when the directory layout or the way it is produced changes
+    static constexpr uint32_t formatVersion = 2;
+
+    enum class Source
+    {
+        // Learned by the tracker of this detector
+        Built,
+        // Learned by another detector of this process
+        Memory,
+        // Learned by a previous run
+        Disk
+    };
+
+    using CreateFn = std::function<void(const std::filesystem::path& trackingConfigFilepath)>;
+
+    static InitStateCache& global();
+
+    // Disabled until a directory is set
+    void setDirectory(const std::optional<std::filesystem::path>& cacheDir);
+    bool isEnabled() const;
+
+    // FNV-1a hash of the configuration and of all model files it references
+    static std::string computeKey(
+        const std::string& trackingConfigFilepath,
+        const nlohmann::json& trackingConfig);
+
+    // Creates the tracker with createFn from the caching copy of the tracking configuration. If
+    // the data of the key is not cached yet, the first caller learns it while concurrent callers
+    // for the same key wait until its tracker has been created. A lock file next to the entry
+    // does the same for other processes sharing the directory.
+    Source createTracker(
+        const std::string& trackingConfigFilepath,
+        const nlohmann::json& trackingConfig,
+        const CreateFn& createFn);
+
+private:
+    std::filesystem::path composeEntryPath(const std::string& key) const;
+
+    mutable std::mutex _mutex;
+    std::optional<std::filesystem::path> _cacheDir;
+    std::map<std::string, std::shared_future<void>> _entries;
+};
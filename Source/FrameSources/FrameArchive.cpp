@@ -0,0 +1,292 @@
+#include <FrameSources/FrameArchive.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef VLDEMO_WITH_LZ4
+#include <lz4.h>
+#endif
+
+using namespace FrameArchive;
+
+namespace
+{
+constexpr auto archiveFileName = "multiViewImages.vlfa";
+
+size_t getPlaneSize(const CameraEntry& camera)
+{
+    return static_cast<size_t>(camera.step) * camera.height;
+}
+
+CameraEntry toCameraEntry(const cv::Mat& image)
+{
+    if (image.depth() != CV_8U)
+    {
+        throw std::runtime_error("Frame archives only support 8-bit images");
+    }
+    return {
+        static_cast<uint32_t>(image.cols),
+        static_cast<uint32_t>(image.rows),
+        static_cast<uint32_t>(image.type()),
+        static_cast<uint32_t>(image.cols * image.elemSize())};
+}
+
+bool isSameLayout(const CameraEntry& a, const CameraEntry& b)
+{
+    return a.width == b.width && a.height == b.height && a.type == b.type && a.step == b.step;
+}
+
+std::vector<char> compressPlane(
+    const cv::Mat& plane, [[maybe_unused]] const Compression compression)
+{
+    const auto planeSize = plane.total() * plane.elemSize();
+#ifdef VLDEMO_WITH_LZ4
+    if (compression == Compression::LZ4)
+    {
+        std::vector<char> compressed(LZ4_compressBound(static_cast<int>(planeSize)));
+        const auto compressedSize = LZ4_compress_default(
+            reinterpret_cast<const char*>(plane.data),
+            compressed.data(),
+            static_cast<int>(planeSize),
+            static_cast<int>(compressed.size()));
+        if (compressedSize > 0 && static_cast<size_t>(compressedSize) < planeSize)
+        {
+            compressed.resize(compressedSize);
+            return compressed;
+        }
+    }
+#endif
+    const auto* begin = reinterpret_cast<const char*>(plane.data);
+    return std::vector<char>(begin, begin + planeSize);
+}
+
+void decompressPlane(
+    [[maybe_unused]] const unsigned char* stored,
+    [[maybe_unused]] const PlaneEntry& plane,
+    [[maybe_unused]] cv::Mat& image)
+{
+#ifdef VLDEMO_WITH_LZ4
+    const auto planeSize = image.total() * image.elemSize();
+    const auto decompressedSize = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(stored),
+        reinterpret_cast<char*>(image.data),
+        static_cast<int>(plane.storedSize),
+        static_cast<int>(planeSize));
+    if (decompressedSize < 0 || static_cast<size_t>(decompressedSize) != planeSize)
+    {
+        throw std::runtime_error("Corrupt compressed plane in frame archive");
+    }
+#else
+    throw std::runtime_error("Frame archive is compressed, but LZ4 support is not built in");
+#endif
+}
+
+template<typename T>
+void writeStruct(std::ofstream& file, const T& data)
+{
+    file.write(reinterpret_cast<const char*>(&data), sizeof(T));
+}
+
+template<typename T>
+T readStruct(const MemoryMappedFile& file, const size_t offset)
+{
+    if (offset + sizeof(T) > file.size())
+    {
+        throw std::runtime_error("Frame archive is truncated");
+    }
+    T data;
+    std::memcpy(&data, file.data() + offset, sizeof(T));
+    return data;
+}
+} // namespace
+
+std::string FrameArchive::composeArchivePath(const std::string& imageDir)
+{
+    return imageDir + "/" + archiveFileName;
+}
+
+bool FrameArchive::isCompressionSupported(const Compression compression)
+{
+#ifdef VLDEMO_WITH_LZ4
+    return compression == Compression::None || compression == Compression::LZ4;
+#else
+    return compression == Compression::None;
+#endif
+}
+
+size_t FrameArchive::pack(
+    FrameSource& source,
+    const std::string& archivePath,
+    const Compression compression)
+{
+    if (!isCompressionSupported(compression))
+    {
+        throw std::runtime_error("Compression method not supported by this build");
+    }
+    const auto frameCount = source.getFrameCount();
+    if (frameCount == 0)
+    {
+        throw std::runtime_error("No frames to pack");
+    }
+
+    std::vector<CameraEntry> cameras;
+    for (const auto& image : source.loadFrame(0))
+    {
+        cameras.push_back(toCameraEntry(image));
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.compression = static_cast<uint32_t>(compression);
+    header.cameraCount = static_cast<uint32_t>(cameras.size());
+    header.frameCount = static_cast<uint32_t>(frameCount);
+    header.alignment = planeAlignment;
+
+    std::filesystem::create_directories(std::filesystem::path(archivePath).parent_path());
+    // Written under a temporary name, so that an interrupted run does not leave a truncated
+    // archive which is newer than the TIFF files
+    const auto temporaryPath = archivePath + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Unable to create frame archive " + archivePath);
+    }
+
+    try
+    {
+        // The tables are written again once the offsets of all planes are known
+        std::vector<PlaneEntry> planes(frameCount * cameras.size(), PlaneEntry {0, 0});
+        const auto writeTables = [&]()
+        {
+            writeStruct(file, header);
+            for (const auto& camera : cameras)
+            {
+                writeStruct(file, camera);
+            }
+            for (const auto& plane : planes)
+            {
+                writeStruct(file, plane);
+            }
+        };
+        writeTables();
+
+        for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+        {
+            const auto frame = source.loadFrame(frameIdx);
+            if (frame.size() != cameras.size())
+            {
+                throw std::runtime_error(
+                    "Frame " + std::to_string(frameIdx) + " has a different number of images");
+            }
+            for (size_t camIdx = 0; camIdx < cameras.size(); camIdx++)
+            {
+                if (!isSameLayout(toCameraEntry(frame[camIdx]), cameras[camIdx]))
+                {
+                    throw std::runtime_error(
+                        "Image " + std::to_string(camIdx) + " of frame " +
+                        std::to_string(frameIdx) + " differs in size or type from the first frame");
+                }
+                const auto plane = frame[camIdx].isContinuous() ? frame[camIdx]
+                                                                : frame[camIdx].clone();
+                const auto stored = compressPlane(plane, compression);
+
+                const auto position = static_cast<uint64_t>(file.tellp());
+                const auto offset =
+                    (position + planeAlignment - 1) / planeAlignment * planeAlignment;
+                file.write(std::vector<char>(offset - position, 0).data(), offset - position);
+                file.write(stored.data(), stored.size());
+                planes[frameIdx * cameras.size() + camIdx] = {offset, stored.size()};
+            }
+        }
+
+        file.seekp(0);
+        writeTables();
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Unable to write frame archive " + archivePath);
+        }
+    }
+    catch (...)
+    {
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(temporaryPath, error);
+        throw;
+    }
+    std::filesystem::rename(temporaryPath, archivePath);
+    return frameCount;
+}
+
+ArchiveFrameSource::ArchiveFrameSource(const std::string& archivePath) :
+    _file(archivePath), _header(readStruct<FileHeader>(_file, 0))
+{
+    if (std::memcmp(_header.magic, magic, sizeof(magic)) != 0 || _header.version != version)
+    {
+        throw std::runtime_error(archivePath + " is not a supported frame archive");
+    }
+    if (!isCompressionSupported(static_cast<Compression>(_header.compression)))
+    {
+        throw std::runtime_error("Compression method of " + archivePath + " is not supported");
+    }
+
+    auto offset = sizeof(FileHeader);
+    for (uint32_t camIdx = 0; camIdx < _header.cameraCount; camIdx++)
+    {
+        _cameras.push_back(readStruct<CameraEntry>(_file, offset));
+        offset += sizeof(CameraEntry);
+    }
+    const auto planeCount = static_cast<size_t>(_header.frameCount) * _header.cameraCount;
+    for (size_t planeIdx = 0; planeIdx < planeCount; planeIdx++)
+    {
+        const auto plane = readStruct<PlaneEntry>(_file, offset);
+        if (plane.offset + plane.storedSize > _file.size())
+        {
+            throw std::runtime_error(archivePath + " is truncated");
+        }
+        _planes.push_back(plane);
+        offset += sizeof(PlaneEntry);
+    }
+}
+
+size_t ArchiveFrameSource::getFrameCount() const
+{
+    return _header.frameCount;
+}
+
+Frame ArchiveFrameSource::loadFrame(const size_t frameIdx)
+{
+    if (frameIdx >= _header.frameCount)
+    {
+        throw std::runtime_error("Frame " + std::to_string(frameIdx) + " is not in the archive");
+    }
+
+    Frame frame;
+    frame.reserve(_cameras.size());
+    for (size_t camIdx = 0; camIdx < _cameras.size(); camIdx++)
+    {
+        const auto& camera = _cameras[camIdx];
+        const auto& plane = _planes[frameIdx * _cameras.size() + camIdx];
+        const auto* stored = _file.data() + plane.offset;
+        if (plane.storedSize == getPlaneSize(camera))
+        {
+            // cv::Mat has no read-only views, the mapping must not be written to
+            frame.emplace_back(
+                camera.height,
+                camera.width,
+                camera.type,
+                const_cast<unsigned char*>(stored),
+                camera.step);
+        }
+        else
+        {
+            cv::Mat image(camera.height, camera.width, camera.type);
+            decompressPlane(stored, plane, image);
+            frame.push_back(image);
+        }
+    }
+    return frame;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <FrameSources/FrameSource.h>
+#include <FrameSources/MemoryMappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A frame archive stores the images of a whole sequence as raw 8-bit planes, so that frames can
+// be used straight from a memory mapping instead of decoding TIFF files on every run.
+//
+// Layout (host byte order):
+//   FileHeader
+//   CameraEntry[cameraCount]
+//   PlaneEntry[frameCount * cameraCount]    ordered by frame, then camera
+//   planes, each starting at a multiple of FileHeader::alignment
+namespace FrameArchive
+{
+enum class Compression : uint32_t
+{
+    None = 0,
+    LZ4 = 1
+};
+
+constexpr char magic[8] = {'V', 'L', 'F', 'R', 'A', 'M', 'E', 'S'};
+constexpr uint32_t version = 1;
+constexpr uint32_t planeAlignment = 4096;
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t compression;
+    uint32_t cameraCount;
+    uint32_t frameCount;
+    uint32_t alignment;
+    uint32_t reserved[3];
+};
+
+struct CameraEntry
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t type;
+    uint32_t step;
+};
+
+// A plane is stored uncompressed if its compressed size would not be smaller
+struct PlaneEntry
+{
+    uint64_t offset;
+    uint64_t storedSize;
+};
+
+static_assert(sizeof(FileHeader) == 40, "Unexpected padding in FileHeader");
+static_assert(sizeof(CameraEntry) == 16, "Unexpected padding in CameraEntry");
+static_assert(sizeof(PlaneEntry) == 16, "Unexpected padding in PlaneEntry");
+
+std::string composeArchivePath(const std::string& imageDir);
+bool isCompressionSupported(const Compression compression);
+
+// Writes all frames of the source to the archive and returns the number of frames
+size_t pack(FrameSource& source, const std::string& archivePath, const Compression compression);
+} // namespace FrameArchive
+
+class ArchiveFrameSource : public FrameSource
+{
+public:
+    explicit ArchiveFrameSource(const std::string& archivePath);
+
+    size_t getFrameCount() const override;
+    // Uncompressed planes are returned as read-only views into the mapped archive. They stay
+    // valid as long as this frame source exists.
+    Frame loadFrame(const size_t frameIdx) override;
+
+private:
+    MemoryMappedFile _file;
+    FrameArchive::FileHeader _header;
+    std::vector<FrameArchive::CameraEntry> _cameras;
+    std::vector<FrameArchive::PlaneEntry> _planes;
+};
@@ -0,0 +1,78 @@
+#include <FrameSources/FrameSource.h>
+
+#include <FrameSources/FrameArchive.h>
+#include <Helpers/DataProcessingHelpers.h>
+
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+// The archive is stale if the TIFF files were re-recorded after packing. Without any TIFF files
+// (e.g. only the archive was copied to this machine) the archive is used as is.
+bool isArchiveUpToDate(const ArchiveFrameSource& archive, const std::string& imageDir)
+{
+    const auto archiveTime =
+        std::filesystem::last_write_time(FrameArchive::composeArchivePath(imageDir));
+    size_t tiffCount = 0;
+    while (true)
+    {
+        const auto imagePath = DataProcessingHelpers::composeImagePath(imageDir, tiffCount);
+        std::error_code error;
+        const auto imageTime = std::filesystem::last_write_time(imagePath, error);
+        if (error)
+        {
+            break;
+        }
+        if (imageTime > archiveTime)
+        {
+            return false;
+        }
+        tiffCount++;
+    }
+    return tiffCount == 0 || tiffCount == archive.getFrameCount();
+}
+} // namespace
+
+TiffFrameSource::TiffFrameSource(const std::string& imageDir) : _imageDir(imageDir), _frameCount(0)
+{
+    while (std::filesystem::exists(DataProcessingHelpers::composeImagePath(_imageDir, _frameCount)))
+    {
+        _frameCount++;
+    }
+}
+
+size_t TiffFrameSource::getFrameCount() const
+{
+    return _frameCount;
+}
+
+Frame TiffFrameSource::loadFrame(const size_t frameIdx)
+{
+    return DataProcessingHelpers::loadFrame(
+        DataProcessingHelpers::composeImagePath(_imageDir, frameIdx));
+}
+
+std::unique_ptr<FrameSource> createFrameSource(const std::string& imageDir)
+{
+    const auto archivePath = FrameArchive::composeArchivePath(imageDir);
+    if (std::filesystem::exists(archivePath))
+    {
+        try
+        {
+            auto archive = std::make_unique<ArchiveFrameSource>(archivePath);
+            if (isArchiveUpToDate(*archive, imageDir))
+            {
+                return archive;
+            }
+            std::cerr << "Ignoring stale frame archive " << archivePath
+                      << ", repack it with FrameArchiveConverter" << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Ignoring frame archive: " << e.what()
+                      << ", repack it with FrameArchiveConverter" << std::endl;
+        }
+    }
+    return std::make_unique<TiffFrameSource>(imageDir);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using Frame = std::vector<cv::Mat>;
+
+// Provides the frames of a recorded image sequence by index
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    virtual size_t getFrameCount() const = 0;
+    virtual Frame loadFrame(const size_t frameIdx) = 0;
+};
+
+// Reads the multipage TIFF files multiViewImage_<N>.tif of the image sequence directory
+class TiffFrameSource : public FrameSource
+{
+public:
+    explicit TiffFrameSource(const std::string& imageDir);
+
+    size_t getFrameCount() const override;
+    Frame loadFrame(const size_t frameIdx) override;
+
+private:
+    std::string _imageDir;
+    size_t _frameCount;
+};
+
+// Uses the frame archive (see FrameArchive.h) in the image sequence directory if there is one
+// and it is not older than the TIFF files and holds as many frames, otherwise the TIFF files.
+// Archives which cannot be opened are ignored with a warning as well.
+std::unique_ptr<FrameSource> createFrameSource(const std::string& imageDir);
@@ -0,0 +1,95 @@
+#include <FrameSources/MemoryMappedFile.h>
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MemoryMappedFile::MemoryMappedFile(const std::string& path)
+{
+    _fileHandle = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Unable to open " + path);
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(_fileHandle, &fileSize);
+    _size = static_cast<size_t>(fileSize.QuadPart);
+
+    _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mappingHandle)
+    {
+        CloseHandle(_fileHandle);
+        throw std::runtime_error("Unable to map " + path);
+    }
+    _data = static_cast<const unsigned char*>(
+        MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!_data)
+    {
+        CloseHandle(_mappingHandle);
+        CloseHandle(_fileHandle);
+        throw std::runtime_error("Unable to map " + path);
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+    CloseHandle(_fileHandle);
+}
+#else
+MemoryMappedFile::MemoryMappedFile(const std::string& path)
+{
+    _fileDescriptor = open(path.c_str(), O_RDONLY);
+    if (_fileDescriptor < 0)
+    {
+        throw std::runtime_error("Unable to open " + path);
+    }
+    struct stat fileStatus;
+    if (fstat(_fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+    {
+        close(_fileDescriptor);
+        throw std::runtime_error("Unable to map empty or unreadable file " + path);
+    }
+    _size = static_cast<size_t>(fileStatus.st_size);
+
+    auto* mapping = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close(_fileDescriptor);
+        throw std::runtime_error("Unable to map " + path);
+    }
+    _data = static_cast<const unsigned char*>(mapping);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    munmap(const_cast<unsigned char*>(_data), _size);
+    close(_fileDescriptor);
+}
+#endif
+
+const unsigned char* MemoryMappedFile::data() const
+{
+    return _data;
+}
+
+size_t MemoryMappedFile::size() const
+{
+    return _size;
+}
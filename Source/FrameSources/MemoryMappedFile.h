@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file
+class MemoryMappedFile
+{
+public:
+    explicit MemoryMappedFile(const std::string& path);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const unsigned char* data() const;
+    size_t size() const;
+
+private:
+    const unsigned char* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#else
+    int _fileDescriptor = -1;
+#endif
+};
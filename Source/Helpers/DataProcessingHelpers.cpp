@@ -1,10 +1,20 @@
 #include <Helpers/DataProcessingHelpers.h>
 
+#include <Metrics/MetricsRegistry.h>
+
 constexpr auto extrinsicsKeyName = "imageFileName";
 constexpr int indentNumSpaces = 4;
 
 namespace
 {
+Metrics::Histogram& getIOLatency(const std::string& operation)
+{
+    return Metrics::Registry::global().histogram(
+        "vldemo_io_duration_seconds",
+        "Duration of loading frames and writing images",
+        "operation=\"" + operation + "\"");
+}
+
 nlohmann::json readJsonFile(const std::string& configFilePath)
 {
     std::ifstream ifs(configFilePath);
@@ -29,8 +39,21 @@ std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>
 }
 } // namespace
 
+std::string DataProcessingHelpers::composeImageName(const size_t frameIdx)
+{
+    return "multiViewImage_" + std::to_string(frameIdx);
+}
+
+std::string
+    DataProcessingHelpers::composeImagePath(const std::string& imageDir, const size_t frameIdx)
+{
+    return imageDir + "/" + composeImageName(frameIdx) + ".tif";
+}
+
 DataProcessingHelpers::Frame DataProcessingHelpers::loadFrame(const std::string& path)
 {
+    static auto& latencyHistogram = getIOLatency("load_frame");
+    Metrics::ScopedLatency latency(latencyHistogram);
     DataProcessingHelpers::Frame images;
     if (!cv::imreadmulti(path, images))
     {
@@ -41,6 +64,8 @@ DataProcessingHelpers::Frame DataProcessingHelpers::loadFrame(const std::string&
 
 void DataProcessingHelpers::writeImage(const cv::Mat& cvImage, const std::string& path)
 {
+    static auto& latencyHistogram = getIOLatency("write_image");
+    Metrics::ScopedLatency latency(latencyHistogram);
     std::filesystem::create_directories(std::filesystem::path(path).parent_path());
     cv::imwrite(path, cvImage);
 }
@@ -75,6 +100,7 @@ void DataProcessingHelpers::writeExtrinsicsJson(
         nlohmann::json q =
             nlohmann::json::array({extrinsic.q[0], extrinsic.q[1], extrinsic.q[2], extrinsic.q[3]});
         extrinsicJson["r"] = q;
+        extrinsicJson["valid"] = extrinsic.valid;
         results.push_back(extrinsicJson);
     }
 
@@ -15,6 +15,9 @@ namespace DataProcessingHelpers
 {
 using Frame = std::vector<cv::Mat>;
 
+std::string composeImageName(const size_t frameIdx);
+std::string composeImagePath(const std::string& imageDir, const size_t frameIdx);
+
 Frame loadFrame(const std::string& path);
 void writeImage(const cv::Mat& cvImage, const std::string& path);
 std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>
@@ -3,8 +3,50 @@
 #include <opencv2/imgproc.hpp>
 #include <vlSDK.h>
 
+#include <optional>
 #include <string>
 
+namespace
+{
+int getChannelCount(const ImageHelpers::PixelFormat format)
+{
+    switch (format)
+    {
+        case ImageHelpers::PixelFormat::BGR:
+            return 3;
+        case ImageHelpers::PixelFormat::BGRA:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+// OpenCV names Bayer patterns by the second row's middle pixels, so RGGB is "BayerBG"
+std::optional<int> getConversionCode(const ImageHelpers::PixelFormat format, const bool toGrey)
+{
+    using ImageHelpers::PixelFormat;
+    switch (format)
+    {
+        case PixelFormat::Grey:
+            return toGrey ? std::nullopt : std::optional<int>(cv::COLOR_GRAY2RGB);
+        case PixelFormat::BGR:
+            return toGrey ? cv::COLOR_BGR2GRAY : cv::COLOR_BGR2RGB;
+        case PixelFormat::BGRA:
+            return toGrey ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGRA2RGB;
+        case PixelFormat::BayerRGGB:
+            return toGrey ? cv::COLOR_BayerBG2GRAY : cv::COLOR_BayerBG2RGB;
+        case PixelFormat::BayerBGGR:
+            return toGrey ? cv::COLOR_BayerRG2GRAY : cv::COLOR_BayerRG2RGB;
+        case PixelFormat::BayerGRBG:
+            return toGrey ? cv::COLOR_BayerGB2GRAY : cv::COLOR_BayerGB2RGB;
+        case PixelFormat::BayerGBRG:
+            return toGrey ? cv::COLOR_BayerGR2GRAY : cv::COLOR_BayerGR2RGB;
+        default:
+            throw std::runtime_error("Unknown pixel format");
+    }
+}
+} // namespace
+
 namespace ImageHelpers
 {
 Image toVLImageGrey(const cv::Mat& imageGrey)
@@ -19,6 +61,59 @@ Image toVLImageGrey(const cv::Mat& imageGrey)
     return vlImage;
 }
 
+Image toVLImageRGB(const cv::Mat& imageBGR)
+{
+    if (imageBGR.channels() != 3)
+    {
+        throw std::runtime_error("Given images are not BGR images");
+    }
+
+    cv::Mat imageRGB;
+    cv::cvtColor(imageBGR, imageRGB, cv::COLOR_BGR2RGB);
+    Image vlImage(vlNew_ImageWrapper(vlImageFormat::VL_IMAGE_FORMAT_RGB));
+    vlImageWrapper_CopyFromBuffer(vlImage.get(), imageRGB.data, imageRGB.cols, imageRGB.rows);
+    return vlImage;
+}
+
+Image toVLImage(const cv::Mat& image, const PixelFormat format, const bool toGrey)
+{
+    if (image.depth() != CV_8U || image.channels() != getChannelCount(format))
+    {
+        throw std::runtime_error("Given images do not match the configured pixel format");
+    }
+
+    const auto conversionCode = getConversionCode(format, toGrey);
+    if (!conversionCode.has_value())
+    {
+        return toVLImageGrey(image.isContinuous() ? image : image.clone());
+    }
+
+    // Keeps its allocation across frames as long as the image size does not change
+    thread_local cv::Mat staging;
+    cv::cvtColor(image, staging, conversionCode.value());
+    Image vlImage(vlNew_ImageWrapper(
+        toGrey ? vlImageFormat::VL_IMAGE_FORMAT_GREY : vlImageFormat::VL_IMAGE_FORMAT_RGB));
+    vlImageWrapper_CopyFromBuffer(vlImage.get(), staging.data, staging.cols, staging.rows);
+    return vlImage;
+}
+
+cv::Mat convertImage(const cv::Mat& image, const PixelFormat format, const bool toGrey)
+{
+    if (image.depth() != CV_8U || image.channels() != getChannelCount(format))
+    {
+        throw std::runtime_error("Given images do not match the configured pixel format");
+    }
+
+    const auto conversionCode = getConversionCode(format, toGrey);
+    if (!conversionCode.has_value())
+    {
+        return image;
+    }
+    cv::Mat converted;
+    cv::cvtColor(image, converted, conversionCode.value());
+    return converted;
+}
+
 cv::Mat toCVMat(const Image& vlImage)
 {
     const auto& img = vlImage.get();
@@ -6,7 +6,28 @@
 
 namespace ImageHelpers
 {
+// Layout of the camera images. Bayer patterns are named by the colors of the first 2x2 block.
+enum class PixelFormat
+{
+    Grey,
+    BGR,
+    BGRA,
+    BayerRGGB,
+    BayerBGGR,
+    BayerGRBG,
+    BayerGBRG
+};
+
 Image toVLImageGrey(const cv::Mat& imageRGBA);
+Image toVLImageRGB(const cv::Mat& imageBGR);
+
+// Converts an 8 bit camera image into a grey or RGB VL image. Demosaicing, luma computation and
+// channel reordering are done by a single cvtColor pass into a buffer reused by the calling
+// thread, from which the VL image is filled. Grey images injected as grey are copied directly.
+Image toVLImage(const cv::Mat& image, const PixelFormat format, const bool toGrey);
+// Returns the grey or RGB pixels toVLImage() injects for the image. Allocates on every call;
+// grey images injected as grey are returned without copying.
+cv::Mat convertImage(const cv::Mat& image, const PixelFormat format, const bool toGrey);
 
 cv::Mat toCVMat(const Image& vlImage);
 
@@ -0,0 +1,270 @@
+#include <Metrics/MetricsRegistry.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+void addToDouble(std::atomic<double>& target, const double value)
+{
+    auto current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed))
+    {
+    }
+}
+
+std::string composeLabels(const std::string& labels, const std::string& extraLabel = "")
+{
+    if (labels.empty() && extraLabel.empty())
+    {
+        return "";
+    }
+    const auto separator = labels.empty() || extraLabel.empty() ? "" : ",";
+    return "{" + labels + separator + extraLabel + "}";
+}
+
+std::string formatValue(const double value)
+{
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+}
+} // namespace
+
+namespace Metrics
+{
+void Counter::increment(const uint64_t value)
+{
+    _value.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Counter::get() const
+{
+    return _value.load(std::memory_order_relaxed);
+}
+
+void Gauge::set(const double value)
+{
+    _value.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::add(const double value)
+{
+    addToDouble(_value, value);
+}
+
+double Gauge::get() const
+{
+    return _value.load(std::memory_order_relaxed);
+}
+
+Histogram::Histogram(std::vector<double> upperBounds) :
+    _upperBounds(std::move(upperBounds)),
+    _bucketCounts(std::make_unique<std::atomic<uint64_t>[]>(_upperBounds.size() + 1))
+{
+    if (!std::is_sorted(_upperBounds.begin(), _upperBounds.end()))
+    {
+        throw std::runtime_error("Histogram bucket bounds must be ascending");
+    }
+    for (size_t bucketIdx = 0; bucketIdx <= _upperBounds.size(); bucketIdx++)
+    {
+        _bucketCounts[bucketIdx].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(const double value)
+{
+    const auto bucketIdx =
+        std::lower_bound(_upperBounds.begin(), _upperBounds.end(), value) - _upperBounds.begin();
+    _bucketCounts[bucketIdx].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    addToDouble(_sum, value);
+}
+
+const std::vector<double>& Histogram::getUpperBounds() const
+{
+    return _upperBounds;
+}
+
+std::vector<uint64_t> Histogram::getCumulativeCounts() const
+{
+    std::vector<uint64_t> counts;
+    uint64_t cumulativeCount = 0;
+    for (size_t bucketIdx = 0; bucketIdx <= _upperBounds.size(); bucketIdx++)
+    {
+        cumulativeCount += _bucketCounts[bucketIdx].load(std::memory_order_relaxed);
+        counts.push_back(cumulativeCount);
+    }
+    return counts;
+}
+
+uint64_t Histogram::getCount() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+double Histogram::getSum() const
+{
+    return _sum.load(std::memory_order_relaxed);
+}
+
+std::vector<double> getDefaultLatencyBuckets()
+{
+    return {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+}
+
+Registry& Registry::global()
+{
+    static Registry registry;
+    return registry;
+}
+
+Registry::Family&
+    Registry::getFamily(const std::string& name, const std::string& type, const std::string& help)
+{
+    auto& family = _families[name];
+    if (family.type.empty())
+    {
+        family.type = type;
+        family.help = help;
+    }
+    else if (family.type != type)
+    {
+        throw std::runtime_error("Metric " + name + " is already registered as " + family.type);
+    }
+    return family;
+}
+
+Counter& Registry::counter(
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& metric = getFamily(name, "counter", help).counters[labels];
+    if (!metric)
+    {
+        metric = std::make_unique<Counter>();
+    }
+    return *metric;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& metric = getFamily(name, "gauge", help).gauges[labels];
+    if (!metric)
+    {
+        metric = std::make_unique<Gauge>();
+    }
+    return *metric;
+}
+
+Histogram& Registry::histogram(
+    const std::string& name,
+    const std::string& help,
+    const std::string& labels,
+    std::vector<double> upperBounds)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& metric = getFamily(name, "histogram", help).histograms[labels];
+    if (!metric)
+    {
+        metric = std::make_unique<Histogram>(std::move(upperBounds));
+    }
+    return *metric;
+}
+
+std::string Registry::renderPrometheusText() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::ostringstream text;
+    for (const auto& [name, family] : _families)
+    {
+        text << "# HELP " << name << " " << family.help << "\n";
+        text << "# TYPE " << name << " " << family.type << "\n";
+        for (const auto& [labels, counter] : family.counters)
+        {
+            text << name << composeLabels(labels) << " " << counter->get() << "\n";
+        }
+        for (const auto& [labels, gauge] : family.gauges)
+        {
+            text << name << composeLabels(labels) << " " << formatValue(gauge->get()) << "\n";
+        }
+        for (const auto& [labels, histogram] : family.histograms)
+        {
+            const auto& upperBounds = histogram->getUpperBounds();
+            const auto counts = histogram->getCumulativeCounts();
+            for (size_t bucketIdx = 0; bucketIdx < counts.size(); bucketIdx++)
+            {
+                const auto bound = bucketIdx < upperBounds.size()
+                                       ? formatValue(upperBounds[bucketIdx])
+                                       : std::string("+Inf");
+                text << name << "_bucket" << composeLabels(labels, "le=\"" + bound + "\"") << " "
+                     << counts[bucketIdx] << "\n";
+            }
+            text << name << "_sum" << composeLabels(labels) << " "
+                 << formatValue(histogram->getSum()) << "\n";
+            text << name << "_count" << composeLabels(labels) << " " << histogram->getCount()
+                 << "\n";
+        }
+    }
+    return text.str();
+}
+
+ScopedLatency::ScopedLatency(Histogram& histogram) :
+    _histogram(histogram), _startTime(std::chrono::steady_clock::now())
+{
+}
+
+ScopedLatency::~ScopedLatency()
+{
+    _histogram.observe(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - _startTime).count());
+}
+
+TextFileExporter::TextFileExporter(
+    const std::string& path,
+    const std::chrono::milliseconds interval,
+    const Registry& registry) :
+    _path(path), _interval(interval), _registry(registry)
+{
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path());
+    _thread = std::thread(
+        [this]()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stopRequested.wait_for(lock, _interval, [this]() { return _stopping; }))
+            {
+                writeNow();
+            }
+        });
+}
+
+TextFileExporter::~TextFileExporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _stopRequested.notify_one();
+    _thread.join();
+    writeNow();
+}
+
+void TextFileExporter::writeNow() const
+{
+    std::lock_guard<std::mutex> lock(_writeMutex);
+    const auto temporaryPath = _path + ".tmp";
+    {
+        std::ofstream file(temporaryPath);
+        file << _registry.renderPrometheusText();
+    }
+    // Failing to export metrics must not stop the detection
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, _path, error);
+}
+} // namespace Metrics
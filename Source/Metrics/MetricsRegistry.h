@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counters, gauges and histograms which can be updated lock-free from any thread and rendered
+// in the Prometheus text exposition format. Only registering a metric takes a lock, so callers
+// should keep the returned references.
+namespace Metrics
+{
+class Counter
+{
+public:
+    void increment(const uint64_t value = 1);
+    uint64_t get() const;
+
+private:
+    std::atomic<uint64_t> _value {0};
+};
+
+class Gauge
+{
+public:
+    void set(const double value);
+    void add(const double value);
+    double get() const;
+
+private:
+    std::atomic<double> _value {0.0};
+};
+
+class Histogram
+{
+public:
+    // Upper bounds of the buckets in ascending order, the +Inf bucket is added implicitly
+    explicit Histogram(std::vector<double> upperBounds);
+
+    void observe(const double value);
+
+    const std::vector<double>& getUpperBounds() const;
+    // Cumulative counts per bucket including +Inf
+    std::vector<uint64_t> getCumulativeCounts() const;
+    uint64_t getCount() const;
+    double getSum() const;
+
+private:
+    std::vector<double> _upperBounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> _bucketCounts;
+    std::atomic<uint64_t> _count {0};
+    std::atomic<double> _sum {0.0};
+};
+
+// Bucket bounds in seconds from 1 ms to 10 s
+std::vector<double> getDefaultLatencyBuckets();
+
+class Registry
+{
+public:
+    static Registry& global();
+
+    // Labels are given in Prometheus syntax without braces, e.g. stage="inject"
+    Counter& counter(
+        const std::string& name,
+        const std::string& help,
+        const std::string& labels = "");
+    Gauge&
+        gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    Histogram& histogram(
+        const std::string& name,
+        const std::string& help,
+        const std::string& labels = "",
+        std::vector<double> upperBounds = getDefaultLatencyBuckets());
+
+    std::string renderPrometheusText() const;
+
+private:
+    struct Family
+    {
+        std::string type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    Family& getFamily(const std::string& name, const std::string& type, const std::string& help);
+
+    mutable std::mutex _mutex;
+    std::map<std::string, Family> _families;
+};
+
+// Observes the time between construction and destruction in seconds
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(Histogram& histogram);
+    ~ScopedLatency();
+
+private:
+    Histogram& _histogram;
+    std::chrono::steady_clock::time_point _startTime;
+};
+
+// Periodically rewrites a text file with the rendered metrics, e.g. for the textfile collector
+// of the Prometheus node exporter. The file is replaced atomically.
+class TextFileExporter
+{
+public:
+    TextFileExporter(
+        const std::string& path,
+        const std::chrono::milliseconds interval,
+        const Registry& registry = Registry::global());
+    ~TextFileExporter();
+
+    void writeNow() const;
+
+private:
+    std::string _path;
+    std::chrono::milliseconds _interval;
+    const Registry& _registry;
+    mutable std::mutex _writeMutex;
+    std::mutex _mutex;
+    std::condition_variable _stopRequested;
+    bool _stopping = false;
+    std::thread _thread;
+};
+} // namespace Metrics
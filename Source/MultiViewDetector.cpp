@@ -1,6 +1,7 @@
 #include <MultiViewDetector.h>
 
 #include <Helpers/ImageHelpers.h>
+#include <Metrics/MetricsRegistry.h>
 
 #include <vlSDK.h>
 
@@ -8,134 +9,160 @@ using namespace nlohmann;
 
 namespace
 {
-std::string getCreateTrackerCommand(const std::string& trackerPath)
+struct DetectorMetrics
 {
-    json cmd;
-    cmd["name"] = "createTracker";
-    cmd["param"]["uri"] = trackerPath;
-    return cmd.dump();
-}
+    Metrics::Counter& framesProcessed;
+    Metrics::Counter& validPoses;
+    Metrics::Counter& deadlinesExceeded;
+    Metrics::Counter& commandFailures;
+    Metrics::Gauge& validPoseRatio;
+    Metrics::Counter& bytesInjected;
+    Metrics::Histogram& convertLatency;
+    Metrics::Histogram& resetLatency;
+    Metrics::Histogram& injectLatency;
+    Metrics::Histogram& trackLatency;
+    Metrics::Histogram& readbackLatency;
+};
 
-std::string getRunTrackingCommand()
+DetectorMetrics& getMetrics()
 {
-    json cmd;
-    cmd["name"] = "runTracking";
-    return cmd.dump();
-}
-
-std::string getResetHardCommand(const std::string& trackerName)
-{
-    json cmd;
-    cmd["nodeName"] = trackerName;
-    cmd["content"]["name"] = "resetHard";
-    return cmd.dump();
+    static const auto stageLatency = [](const std::string& stage) -> Metrics::Histogram&
+    {
+        return Metrics::Registry::global().histogram(
+            "vldemo_stage_duration_seconds",
+            "Duration of the pipeline stages",
+            "stage=\"" + stage + "\"");
+    };
+    auto& registry = Metrics::Registry::global();
+    static DetectorMetrics metrics = {
+        registry.counter("vldemo_frames_processed_total", "Frames processed by all detectors"),
+        registry.counter("vldemo_valid_poses_total", "Frames with a valid pose"),
+        registry.counter(
+            "vldemo_deadlines_exceeded_total", "Frames abandoned because of their deadline"),
+        registry.counter(
+            "vldemo_command_failures_total", "Frames abandoned because of a failed command"),
+        registry.gauge("vldemo_valid_pose_ratio", "Ratio of processed frames with a valid pose"),
+        registry.counter("vldemo_injected_bytes_total", "Bytes of image data injected"),
+        stageLatency("convert"),
+        stageLatency("reset"),
+        stageLatency("inject"),
+        stageLatency("track"),
+        stageLatency("readback")};
+    return metrics;
 }
 
-std::string setAttributeCommand(const std::string& attributeName, const std::string& value)
+void recordMetrics(const DetectionResult& result)
 {
-    json cmd;
-    cmd["name"] = "setAttribute";
-    cmd["param"]["att"] = attributeName;
-    cmd["param"]["val"] = value;
-    return cmd.dump();
+    auto& metrics = getMetrics();
+    if (result.status == DetectionStatus::DeadlineExceeded)
+    {
+        metrics.deadlinesExceeded.increment();
+        return;
+    }
+    if (result.status == DetectionStatus::CommandFailed)
+    {
+        metrics.commandFailures.increment();
+        return;
+    }
+    metrics.framesProcessed.increment();
+    if (result.extrinsic.valid)
+    {
+        metrics.validPoses.increment();
+    }
+    metrics.validPoseRatio.set(
+        static_cast<double>(metrics.validPoses.get()) / metrics.framesProcessed.get());
 }
 
-std::string setInitPoseCommand(const ExtrinsicDataHelpers::Extrinsic& extrinsic)
+Metrics::Histogram& getStartupLatency(const bool warm)
 {
-    json setInitPoseCommand;
-    setInitPoseCommand["name"] = "setInitPose";
-    setInitPoseCommand["param"]["t"][0] = extrinsic.t.at(0);
-    setInitPoseCommand["param"]["t"][1] = extrinsic.t.at(1);
-    setInitPoseCommand["param"]["t"][2] = extrinsic.t.at(2);
-    setInitPoseCommand["param"]["r"][0] = extrinsic.q.at(0);
-    setInitPoseCommand["param"]["r"][1] = extrinsic.q.at(1);
-    setInitPoseCommand["param"]["r"][2] = extrinsic.q.at(2);
-    setInitPoseCommand["param"]["r"][3] = extrinsic.q.at(3);
-    return setInitPoseCommand.dump();
+    return Metrics::Registry::global().histogram(
+        "vldemo_startup_duration_seconds",
+        "Duration of the detector construction",
+        warm ? "start=\"warm\"" : "start=\"cold\"",
+        {0.1, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0, 60.0, 120.0});
 }
 
-std::string execute(const Worker& worker, const std::string& cmd)
+DetectionResult throwIfCommandFailed(DetectionResult result)
 {
-    using StringPair = std::pair<std::string, std::string>;
-    StringPair result;
-    if (!vlWorker_ProcessJsonCommandSync(
-            worker.get(),
-            cmd.c_str(),
-            [](const char* error, const char* data, void* clientData)
-            {
-                auto& result = *reinterpret_cast<StringPair*>(clientData);
-                result.first = error ? error : "";
-                result.second = data ? data : "";
-            },
-            &result))
+    if (result.status == DetectionStatus::CommandFailed)
     {
         throw std::runtime_error(
-            "Command " + cmd + " could not be processed. Invalid JSON or unsupported command.");
+            result.error.empty() ? "The tracker did not accept the commands of the frame"
+                                 : result.error);
     }
-    if (!result.first.empty())
-    {
-        const auto resultJson = json::parse(result.first);
-        throw std::runtime_error(resultJson["message"].get<std::string>());
-    }
-    return result.second;
+    return result;
 }
+} // namespace
 
-Worker
-    createSyncWorker(const std::string& licenseFilepath, const std::string& trackingConfigFilepath)
+MultiViewDetector::MultiViewDetector(
+    const std::string& licenseFilepath,
+    const std::string& trackingConfigFilepath,
+    const WorkerBackendType backendType) :
+    MultiViewDetector(createWorkerBackend(backendType), licenseFilepath, trackingConfigFilepath)
 {
-    Worker worker(vlNew_SyncWorker());
-    if (!vlWorker_Start(worker.get()))
-    {
-        throw std::runtime_error("vlWorker_Start returned false.");
-    }
-    if (!vlWorker_SetLicenseFilePath(worker.get(), licenseFilepath.c_str()))
-    {
-        throw std::runtime_error("Could not set License");
-    }
-
-    try
-    {
-        execute(worker, getCreateTrackerCommand(trackingConfigFilepath));
-    }
-    catch (std::runtime_error& e)
-    {
-        throw std::runtime_error("Could not create tracker: " + std::string(e.what()));
-    }
-    try
-    {
-        execute(worker, getRunTrackingCommand());
-    }
-    catch (std::runtime_error& e)
-    {
-        throw std::runtime_error("Could not enable tracking: " + std::string(e.what()));
-    }
-    if (!vlWorker_IsRunning(worker.get()))
-    {
-        throw std::runtime_error("Tracker is not Running");
-    }
-    return worker;
 }
-} // namespace
 
 MultiViewDetector::MultiViewDetector(
+    std::unique_ptr<WorkerBackend> backend,
     const std::string& licenseFilepath,
     const std::string& trackingConfigFilepath) :
-    _worker(createSyncWorker(licenseFilepath, trackingConfigFilepath))
+    _backend(std::move(backend))
 {
-    unsigned long resultLength;
-    auto resultPtr = ByteBuffer(vlSDKUtil_get(trackingConfigFilepath.c_str(), &resultLength));
-    if (!resultPtr)
+    const auto startTime = std::chrono::steady_clock::now();
+    auto configJson = json::parse(_backend->loadTrackingConfiguration(trackingConfigFilepath));
+    if (InitStateCache::global().isEnabled())
     {
-        throw std::runtime_error(
-            "Could not retrieve tracking configuration file from " + trackingConfigFilepath);
+        // Learning the AutoInit data is part of creating the tracker
+        _startupReport.initStateSource = InitStateCache::global().createTracker(
+            trackingConfigFilepath,
+            configJson,
+            [this, &licenseFilepath](const std::filesystem::path& cachedConfigFilepath)
+            { _backend->startTracking(licenseFilepath, cachedConfigFilepath.string()); });
+    }
+    else
+    {
+        _backend->startTracking(licenseFilepath, trackingConfigFilepath);
     }
-    auto configJson = json::parse(resultPtr.get());
 
     _trackerName = configJson["tracker"]["name"].get<std::string>();
     _anchorName = configJson["tracker"]["parameters"]["anchors"][0]["name"].get<std::string>();
     _inputName = configJson["input"]["useImageSource"].get<std::string>();
     _cameraCount =
         configJson["tracker"]["parameters"]["anchors"][0]["parameters"]["trackingCameras"].size();
+    for (const auto& imageSource : configJson["input"].value("imageSources", json::array()))
+    {
+        if (imageSource.value("name", "") == _inputName && imageSource.contains("data"))
+        {
+            _injectGreyImages = imageSource["data"].value("useGreyImage", true);
+        }
+    }
+
+    _resetHardCommand = TrackerCommands::resetHard(_trackerName);
+    for (size_t camIdx = 0; camIdx < _cameraCount; camIdx++)
+    {
+        _injectImageKeys.push_back("injectImage_" + std::to_string(camIdx));
+        _lineModelImageKeys.push_back("imageLineModel_" + std::to_string(camIdx));
+    }
+    _textureImageKey = "mappedTexture" + _anchorName;
+
+    _startupReport.duration = std::chrono::steady_clock::now() - startTime;
+    getStartupLatency(_startupReport.isWarm())
+        .observe(std::chrono::duration<double>(_startupReport.duration).count());
+}
+
+MultiViewDetector::~MultiViewDetector()
+{
+    // Jobs queued by submit() use the members of this detector, so they have to finish before
+    // the members are destroyed. Jobs run in order, so all of them are done once this one is.
+    std::promise<void> drained;
+    auto done = drained.get_future();
+    _backend->post([&drained]() { drained.set_value(); });
+    done.wait();
+}
+
+bool StartupReport::isWarm() const
+{
+    return initStateSource.has_value() && initStateSource.value() != InitStateCache::Source::Built;
 }
 
 void MultiViewDetector::enableTextureMapping(
@@ -143,97 +170,373 @@ void MultiViewDetector::enableTextureMapping(
     std::optional<nlohmann::json> config)
 {
     std::string enabledString = enabled ? "true" : "false";
-    execute(_worker, setAttributeCommand("textureMappingEnabled", enabledString));
+    execute(TrackerCommands::setAttribute("textureMappingEnabled", enabledString));
     _textureMappingEnabled = enabled;
 
     if (config.has_value())
     {
-        execute(_worker, setAttributeCommand("textureMappingConfig", config.value().dump()));
+        execute(TrackerCommands::setAttribute("textureMappingConfig", config.value().dump()));
     }
 }
 
 void MultiViewDetector::disablePoseEstimation(const bool disableEstimation)
 {
-    execute(
-        _worker,
-        setAttributeCommand("disablePoseEstimation", disableEstimation ? "true" : "false"));
+    execute(TrackerCommands::setAttribute(
+        "disablePoseEstimation", disableEstimation ? "true" : "false"));
+}
+
+void MultiViewDetector::setInputPixelFormat(const ImageHelpers::PixelFormat format)
+{
+    _inputPixelFormat = format;
+    _backend->setInputPixelFormat(format);
+    if (const auto recorder = std::atomic_load(&_recorder))
+    {
+        recorder->recordPixelFormat(format);
+    }
+}
+
+void MultiViewDetector::enableSessionRecording(const std::string& sessionFilepath)
+{
+    auto recorder = std::make_shared<Recording::SessionRecorder>(sessionFilepath);
+    // The frames are recorded as they are submitted, so replaying them needs their format
+    recorder->recordPixelFormat(_inputPixelFormat);
+    std::atomic_store(&_recorder, std::move(recorder));
+}
+
+void MultiViewDetector::disableSessionRecording()
+{
+    std::atomic_store(&_recorder, std::shared_ptr<Recording::SessionRecorder>());
+}
+
+void MultiViewDetector::replayCommand(const std::string& cmd)
+{
+    // Keep track of texture mapping, since getTextureImage() depends on it
+    const auto cmdJson = json::parse(cmd);
+    if (cmdJson.value("name", "") == "setAttribute" &&
+        cmdJson["param"].value("att", "") == "textureMappingEnabled")
+    {
+        _textureMappingEnabled = cmdJson["param"].value("val", "") == "true";
+    }
+    execute(cmd);
+}
+
+bool MultiViewDetector::pinWorkerThread(const Scheduling::CpuSet& cpus)
+{
+    std::promise<bool> pinned;
+    auto result = pinned.get_future();
+    _backend->post(
+        [&pinned, &cpus]()
+        {
+            try
+            {
+                pinned.set_value(Scheduling::pinCurrentThread(cpus));
+            }
+            catch (...)
+            {
+                pinned.set_exception(std::current_exception());
+            }
+        });
+    return result.get();
+}
+
+bool MultiViewDetector::hasWorkerThread() const
+{
+    return _backend->hasDispatcherThread();
 }
 
 ExtrinsicDataHelpers::Extrinsic MultiViewDetector::runDetection(const Frame& frame)
 {
-    // Without reset, the tracker tries to find the object based on the pose in the previous
-    // frame
-    resetTracker();
-    injectFrame(frame);
-    vlWorker_RunOnceSync(_worker.get());
-    return getExtrinsic();
+    DetectionRequest request;
+    request.frame = frame;
+    return throwIfCommandFailed(submit(std::move(request)).get()).extrinsic;
 }
 
 void MultiViewDetector::runWithExternalTracking(
     const Frame& frame,
     const ExtrinsicDataHelpers::Extrinsic& extrinsic)
 {
-    resetTracker();
-    injectFrame(frame);
-    injectExtrinsic(extrinsic);
-    vlWorker_RunOnceSync(_worker.get());
+    DetectionRequest request;
+    request.frame = frame;
+    request.externalExtrinsic = extrinsic;
+    throwIfCommandFailed(submit(std::move(request)).get());
+}
+
+std::future<DetectionResult> MultiViewDetector::submit(DetectionRequest request)
+{
+    const auto recorder = std::atomic_load(&_recorder);
+    const auto frameId = _nextFrameId++;
+    if (recorder)
+    {
+        recorder->recordFrame(
+            frameId,
+            request.frame,
+            request.externalExtrinsic,
+            request.fetchLineModelImages,
+            request.fetchTextureImage);
+    }
+    // Started after recording, so that the recorded latency is comparable with a replay
+    const auto submitTime = std::chrono::steady_clock::now();
+
+    // Shared, since the job has to be copyable and VL images are not
+    std::shared_ptr<std::vector<Image>> images;
+    {
+        Metrics::ScopedLatency latency(getMetrics().convertLatency);
+        images = std::make_shared<std::vector<Image>>(toVLImages(request.frame));
+    }
+    request.frame.clear();
+    auto sharedRequest = std::make_shared<DetectionRequest>(std::move(request));
+    auto promise = std::make_shared<std::promise<DetectionResult>>();
+    auto future = promise->get_future();
+
+    _backend->post(
+        [this, images, sharedRequest, promise, recorder, frameId, submitTime]()
+        {
+            try
+            {
+                _lastProcessedFrameId = frameId;
+                auto result = process(*sharedRequest, *images);
+                recordMetrics(result);
+                if (recorder)
+                {
+                    recorder->recordResult(
+                        frameId,
+                        result.status == DetectionStatus::DeadlineExceeded,
+                        result.extrinsic,
+                        std::chrono::steady_clock::now() - submitTime,
+                        result.textureImage);
+                }
+                if (sharedRequest->onResult)
+                {
+                    sharedRequest->onResult(result);
+                }
+                promise->set_value(std::move(result));
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    return future;
+}
+
+DetectionResult MultiViewDetector::process(
+    const DetectionRequest& request,
+    const std::vector<Image>& images)
+{
+    const auto isLate = [&request]()
+    {
+        return request.deadline.has_value() &&
+               std::chrono::steady_clock::now() > request.deadline.value();
+    };
+
+    DetectionResult result;
+    if (isLate())
+    {
+        result.status = DetectionStatus::DeadlineExceeded;
+        return result;
+    }
+
+    if (trackFrame(images, request.externalExtrinsic) != CommandStatus::Ok)
+    {
+        result.status = DetectionStatus::CommandFailed;
+        result.error = _commandError;
+        return result;
+    }
+    if (isLate())
+    {
+        result.status = DetectionStatus::DeadlineExceeded;
+        return result;
+    }
+
+    Metrics::ScopedLatency latency(getMetrics().readbackLatency);
+    result.extrinsic = request.externalExtrinsic.has_value() ? request.externalExtrinsic.value()
+                                                             : getExtrinsic();
+    if (request.fetchLineModelImages)
+    {
+        result.lineModelImages = getLineModelImages();
+    }
+    if (request.fetchTextureImage)
+    {
+        // Recorded with the result
+        result.textureImage = readTextureImage();
+    }
+    return result;
+}
+
+CommandStatus MultiViewDetector::trackFrame(
+    const std::vector<Image>& images,
+    const std::optional<ExtrinsicDataHelpers::Extrinsic>& externalExtrinsic) noexcept
+{
+    _commandError.clear();
+    if (images.size() != _cameraCount)
+    {
+        setCommandError("Number of images in frame does not match number of cameras");
+        return CommandStatus::Rejected;
+    }
+    try
+    {
+        auto& metrics = getMetrics();
+        {
+            // Without reset, the tracker tries to find the object based on the pose in the
+            // previous frame
+            Metrics::ScopedLatency latency(metrics.resetLatency);
+            if (const auto status = resetTracker(); status != CommandStatus::Ok)
+            {
+                return status;
+            }
+        }
+        {
+            Metrics::ScopedLatency latency(metrics.injectLatency);
+            injectFrame(images);
+            if (externalExtrinsic.has_value())
+            {
+                if (const auto status = injectExtrinsic(externalExtrinsic.value());
+                    status != CommandStatus::Ok)
+                {
+                    return status;
+                }
+            }
+        }
+        Metrics::ScopedLatency latency(metrics.trackLatency);
+        _backend->runOnce();
+        return CommandStatus::Ok;
+    }
+    catch (const std::exception& e)
+    {
+        setCommandError(e.what());
+        return CommandStatus::Failed;
+    }
+    catch (...)
+    {
+        return CommandStatus::Failed;
+    }
+}
+
+const std::string& MultiViewDetector::getCommandError() const
+{
+    return _commandError;
+}
+
+unsigned int MultiViewDetector::getCameraCount() const
+{
+    return _cameraCount;
+}
+
+const StartupReport& MultiViewDetector::getStartupReport() const
+{
+    return _startupReport;
 }
 
 // Images of the detected model edges on a black background, one for each camera perspective
 Frame MultiViewDetector::getLineModelImages() const
 {
     std::vector<cv::Mat> images;
-    for (size_t camIdx = 0; camIdx < _cameraCount; camIdx++)
+    for (const auto& key : _lineModelImageKeys)
     {
-        auto key = "imageLineModel_" + std::to_string(camIdx);
-        Image visImage(vlWorker_GetNodeImageSync(_worker.get(), _trackerName.c_str(), key.c_str()));
+        Image visImage(_backend->getNodeImage(_trackerName, key));
         images.push_back(ImageHelpers::toCVMat(visImage));
     }
     return images;
 }
 
 cv::Mat MultiViewDetector::getTextureImage() const
+{
+    auto textureImage = readTextureImage();
+    if (const auto recorder = std::atomic_load(&_recorder))
+    {
+        recorder->recordTexture(_lastProcessedFrameId, textureImage);
+    }
+    return textureImage;
+}
+
+cv::Mat MultiViewDetector::readTextureImage() const
 {
     if (!_textureMappingEnabled)
     {
         throw std::runtime_error("Cannot run getTextureImage() with texture mapping disabled.");
     }
-    Image visImage(vlWorker_GetNodeImageSync(
-        _worker.get(), _trackerName.c_str(), ("mappedTexture" + _anchorName).c_str()));
+    Image visImage(_backend->getNodeImage(_trackerName, _textureImageKey));
     return ImageHelpers::toCVMat(visImage);
 }
 
 ExtrinsicDataHelpers::Extrinsic MultiViewDetector::getExtrinsic() const
 {
-    SimilarityTransform worldFromAnchorTransform(
-        vlWorker_GetWorldFromAnchorTransform(_worker.get(), _anchorName.c_str()));
-    return ExtrinsicDataHelpers::toExtrinsic(worldFromAnchorTransform.get());
+    return _backend->getWorldFromAnchorTransform(_anchorName);
 }
 
-void MultiViewDetector::resetTracker()
+std::string MultiViewDetector::execute(const std::string& cmd)
 {
-    execute(_worker, getResetHardCommand(_trackerName));
+    if (const auto recorder = std::atomic_load(&_recorder))
+    {
+        recorder->recordCommand(cmd, false);
+    }
+    return _backend->execute(cmd);
 }
 
-void MultiViewDetector::injectFrame(const Frame& frame)
+CommandStatus MultiViewDetector::executeInFrame(const char* cmd) noexcept
+{
+    if (const auto recorder = std::atomic_load(&_recorder))
+    {
+        try
+        {
+            recorder->recordCommand(cmd, true);
+        }
+        catch (const std::exception& e)
+        {
+            setCommandError(e.what());
+            return CommandStatus::Failed;
+        }
+    }
+    return _backend->tryExecute(cmd, &_commandError);
+}
+
+void MultiViewDetector::setCommandError(const char* message) noexcept
+{
+    try
+    {
+        _commandError = message;
+    }
+    catch (...)
+    {
+    }
+}
+
+CommandStatus MultiViewDetector::resetTracker() noexcept
+{
+    return executeInFrame(_resetHardCommand.c_str());
+}
+
+std::vector<Image> MultiViewDetector::toVLImages(const Frame& frame) const
 {
     if (frame.size() != _cameraCount)
     {
         throw std::runtime_error(
             "Cannot inject frame: Number of images in frame does not match number of cameras!");
     }
-    for (int camIdx = 0; camIdx < _cameraCount; camIdx++)
+    std::vector<Image> images;
+    images.reserve(frame.size());
+    for (const auto& image : frame)
     {
-        const auto key = "injectImage_" + std::to_string(camIdx);
-        vlWorker_SetNodeImageSync(
-            _worker.get(),
-            ImageHelpers::toVLImageGrey(frame[camIdx]).get(),
-            _inputName.c_str(),
-            key.c_str());
+        images.push_back(ImageHelpers::toVLImage(image, _inputPixelFormat, _injectGreyImages));
     }
+    return images;
 }
 
-void MultiViewDetector::injectExtrinsic(const ExtrinsicDataHelpers::Extrinsic& extrinsic)
+void MultiViewDetector::injectFrame(const std::vector<Image>& images)
 {
-    execute(_worker, setInitPoseCommand(extrinsic));
-}
\ No newline at end of file
+    // The converted images, which are grey or RGB regardless of the input pixel format
+    const size_t bytesPerPixel = _injectGreyImages ? 1 : 3;
+    size_t byteCount = 0;
+    for (size_t camIdx = 0; camIdx < images.size(); camIdx++)
+    {
+        _backend->setNodeImage(images[camIdx], _inputName, _injectImageKeys[camIdx]);
+        byteCount += static_cast<size_t>(vlImageWrapper_GetWidth(images[camIdx].get())) *
+                     vlImageWrapper_GetHeight(images[camIdx].get()) * bytesPerPixel;
+    }
+    getMetrics().bytesInjected.increment(byteCount);
+}
+
+CommandStatus MultiViewDetector::injectExtrinsic(const ExtrinsicDataHelpers::Extrinsic& extrinsic)
+{
+    return executeInFrame(_initPoseCommand.format(extrinsic));
+}
@@ -1,47 +1,171 @@
 #pragma once
 
+#include <Backends/TrackerCommands.h>
+#include <Backends/WorkerBackend.h>
+#include <Caching/InitStateCache.h>
 #include <Helpers/ExtrinsicDataHelpers.h>
+#include <Helpers/ImageHelpers.h>
 #include <Helpers/PointerHandler.h>
+#include <Recording/SessionRecorder.h>
+#include <Scheduling/CpuTopology.h>
 
 #include <nlohmann/json.hpp>
 #include <opencv2/core.hpp>
 #include <vlSDK.h>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 using Frame = std::vector<cv::Mat>;
 
+enum class DetectionStatus
+{
+    Completed,
+    DeadlineExceeded,
+    // The tracker did not accept a command of the frame
+    CommandFailed,
+    // Not started by the DetectionScheduler, since it could not have met its deadline
+    Rejected
+};
+
+struct DetectionResult
+{
+    DetectionStatus status = DetectionStatus::Completed;
+    ExtrinsicDataHelpers::Extrinsic extrinsic = {{0, 0, 0}, {0, 0, 0, 1}, false};
+    // Only filled if requested, since the tracker overrides them with the next frame
+    Frame lineModelImages;
+    cv::Mat textureImage;
+    // The tracker's message if the status is CommandFailed
+    std::string error;
+};
+
+struct DetectionRequest
+{
+    Frame frame;
+    // Runs with external tracking if set, otherwise the pose is detected
+    std::optional<ExtrinsicDataHelpers::Extrinsic> externalExtrinsic;
+    // Results which are not available in time are abandoned
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    bool fetchLineModelImages = false;
+    bool fetchTextureImage = false;
+    std::function<void(const DetectionResult&)> onResult;
+};
+
+struct StartupReport
+{
+    // Not set if InitStateCache::global() is disabled
+    std::optional<InitStateCache::Source> initStateSource;
+    std::chrono::steady_clock::duration duration {};
+
+    // The init state did not have to be learned
+    bool isWarm() const;
+};
+
 class MultiViewDetector
 {
 public:
     MultiViewDetector(
+        const std::string& licenseFilepath,
+        const std::string& trackingConfigFilepath,
+        const WorkerBackendType backendType = WorkerBackendType::Sync);
+    // For backends that need further options, e.g. a StandInWorkerBackend with simulated latency
+    MultiViewDetector(
+        std::unique_ptr<WorkerBackend> backend,
         const std::string& licenseFilepath,
         const std::string& trackingConfigFilepath);
+    // Waits for the frames still queued on the worker
+    ~MultiViewDetector();
 
     void enableTextureMapping(
         const bool enabled,
         std::optional<nlohmann::json> config = std::nullopt);
     void disablePoseEstimation(const bool enabled);
+    // Format of the images in submitted frames, Grey by default. Images are injected as grey or
+    // RGB images depending on useGreyImage of the input in the tracking configuration.
+    // Call before submitting frames.
+    void setInputPixelFormat(const ImageHelpers::PixelFormat format);
 
+    // Pins the thread processing the worker's calls. For the synchronous backend this is the
+    // calling thread.
+    bool pinWorkerThread(const Scheduling::CpuSet& cpus);
+    // Whether the worker's calls run on a thread of their own, which is only the case for the
+    // threaded backend
+    bool hasWorkerThread() const;
+
+    // Records all commands, submitted frames and their results with timestamps to a session
+    // file, which can be replayed with SessionReplay
+    void enableSessionRecording(const std::string& sessionFilepath);
+    void disableSessionRecording();
+    // Executes a command read from a session file
+    void replayCommand(const std::string& cmd);
+
+    // Throw with the tracker's message if it does not accept the commands of the frame
     ExtrinsicDataHelpers::Extrinsic runDetection(const Frame& frame);
     void runWithExternalTracking(
         const Frame& frame,
         const ExtrinsicDataHelpers::Extrinsic& extrinsic);
 
+    // Converts the frame on the calling thread and queues it on the worker. With the
+    // threaded backend this returns immediately, so the next frame can be prepared while
+    // this one is being tracked. Allocates for the converted images and the queued job.
+    std::future<DetectionResult> submit(DetectionRequest request);
+
+    // The steps of submit() for callers managing threads and buffers themselves. trackFrame()
+    // resets the tracker, injects the images and the optional external pose and tracks. It does
+    // not throw and allocates nothing itself, as CommandPathBenchmark verifies with the stand-in
+    // backend; the vlSDK worker may still allocate while processing the commands. It has to run
+    // on the worker thread, which is the calling thread for all but the threaded backend. If it
+    // fails, getCommandError() returns why; only storing this message allocates.
+    std::vector<Image> toVLImages(const Frame& frame) const;
+    CommandStatus trackFrame(
+        const std::vector<Image>& images,
+        const std::optional<ExtrinsicDataHelpers::Extrinsic>& externalExtrinsic) noexcept;
+    const std::string& getCommandError() const;
+
+    unsigned int getCameraCount() const;
+    const StartupReport& getStartupReport() const;
     Frame getLineModelImages() const;
     cv::Mat getTextureImage() const;
     ExtrinsicDataHelpers::Extrinsic getExtrinsic() const;
 
 private:
-    void resetTracker();
-    void injectFrame(const Frame& frame);
-    void injectExtrinsic(const ExtrinsicDataHelpers::Extrinsic& extrinsic);
+    std::string execute(const std::string& cmd);
+    CommandStatus executeInFrame(const char* cmd) noexcept;
+    void setCommandError(const char* message) noexcept;
+    CommandStatus resetTracker() noexcept;
+    void injectFrame(const std::vector<Image>& images);
+    CommandStatus injectExtrinsic(const ExtrinsicDataHelpers::Extrinsic& extrinsic);
+    DetectionResult process(
+        const DetectionRequest& request,
+        const std::vector<Image>& images);
+    cv::Mat readTextureImage() const;
 
-    Worker _worker;
+    std::unique_ptr<WorkerBackend> _backend;
     std::string _trackerName;
     std::string _anchorName;
     std::string _inputName;
     unsigned int _cameraCount;
+    bool _injectGreyImages = true;
+    ImageHelpers::PixelFormat _inputPixelFormat = ImageHelpers::PixelFormat::Grey;
     bool _textureMappingEnabled = false;
+    // Built once, since they are needed for every frame
+    std::string _resetHardCommand;
+    TrackerCommands::InitPoseCommand _initPoseCommand;
+    std::vector<std::string> _injectImageKeys;
+    std::vector<std::string> _lineModelImageKeys;
+    std::string _textureImageKey;
+    StartupReport _startupReport;
+    // Only accessed on the worker thread
+    std::string _commandError;
+    // Accessed atomically, since frames and results are recorded on different threads
+    std::shared_ptr<Recording::SessionRecorder> _recorder;
+    std::atomic<uint64_t> _nextFrameId {0};
+    // The frame which textures fetched with getTextureImage() are recorded for
+    std::atomic<uint64_t> _lastProcessedFrameId {0};
 };
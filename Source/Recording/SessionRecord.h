@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Helpers/ExtrinsicDataHelpers.h>
+#include <Helpers/ImageHelpers.h>
+
+#include <opencv2/core.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A session file starts with the magic "VLSESSN" followed by the format version (one byte) and
+// continues with records until the end of the file. Each record consists of its type (uint8),
+// its timestamp in nanoseconds since the start of the recording (uint64), the payload size
+// (uint32) and the payload. Images are stored PNG-compressed. Readers accept all versions up to
+// their own; sessions before version 3 have no PixelFormat records, so their frames are grey.
+namespace Recording
+{
+constexpr char sessionMagic[7] = {'V', 'L', 'S', 'E', 'S', 'S', 'N'};
+constexpr uint8_t sessionVersion = 3;
+
+enum class RecordType : uint8_t
+{
+    Command = 1,
+    Frame = 2,
+    Result = 3,
+    // Since version 2
+    Texture = 4,
+    // Since version 3
+    PixelFormat = 5
+};
+
+struct SessionRecord
+{
+    RecordType type = RecordType::Command;
+    std::chrono::nanoseconds timestamp {0};
+
+    // Command: commands issued while processing a frame are reproduced by submitting the frame
+    std::string command;
+    bool isPartOfFrame = false;
+
+    // Frame, Result and Texture
+    uint64_t frameId = 0;
+
+    // PixelFormat: the layout of the images of the following frames. Frames without a preceding
+    // PixelFormat record are grey.
+    ImageHelpers::PixelFormat pixelFormat = ImageHelpers::PixelFormat::Grey;
+
+    // Frame
+    std::vector<cv::Mat> images;
+    std::optional<ExtrinsicDataHelpers::Extrinsic> externalExtrinsic;
+    bool fetchLineModelImages = false;
+    bool fetchTextureImage = false;
+
+    // Result
+    bool deadlineExceeded = false;
+    ExtrinsicDataHelpers::Extrinsic extrinsic = {{0, 0, 0}, {0, 0, 0, 1}, false};
+    // Time from submitting the frame until its result was available
+    std::chrono::nanoseconds latency {0};
+
+    // Result and Texture
+    cv::Mat textureImage;
+};
+} // namespace Recording
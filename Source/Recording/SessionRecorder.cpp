@@ -0,0 +1,401 @@
+#include <Recording/SessionRecorder.h>
+
+#include <Metrics/MetricsRegistry.h>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace Recording;
+
+namespace
+{
+Metrics::Counter& getStallCounter()
+{
+    static auto& stalls = Metrics::Registry::global().counter(
+        "vldemo_recording_stalls_total",
+        "Recording calls which waited for the session recorder to catch up");
+    return stalls;
+}
+
+class PayloadWriter
+{
+public:
+    PayloadWriter() = default;
+    explicit PayloadWriter(std::vector<char> payload) : _payload(std::move(payload)) {}
+
+    template<typename T>
+    void write(const T& value)
+    {
+        const auto* bytes = reinterpret_cast<const char*>(&value);
+        _payload.insert(_payload.end(), bytes, bytes + sizeof(T));
+    }
+
+    void writeBytes(const void* data, const size_t size)
+    {
+        write(static_cast<uint32_t>(size));
+        const auto* bytes = static_cast<const char*>(data);
+        _payload.insert(_payload.end(), bytes, bytes + size);
+    }
+
+    void writeExtrinsic(const ExtrinsicDataHelpers::Extrinsic& extrinsic)
+    {
+        write(extrinsic.t);
+        write(extrinsic.q);
+        write(static_cast<uint8_t>(extrinsic.valid));
+    }
+
+    void writeImage(const cv::Mat& image)
+    {
+        std::vector<unsigned char> encoded;
+        if (!image.empty() && !cv::imencode(".png", image, encoded))
+        {
+            throw std::runtime_error("Unable to compress image for the session recording");
+        }
+        writeBytes(encoded.data(), encoded.size());
+    }
+
+    std::vector<char> takePayload()
+    {
+        return std::move(_payload);
+    }
+
+private:
+    std::vector<char> _payload;
+};
+
+class PayloadReader
+{
+public:
+    explicit PayloadReader(const std::vector<char>& payload) : _payload(payload) {}
+
+    template<typename T>
+    T read()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::vector<char> readBytes()
+    {
+        const auto size = read<uint32_t>();
+        const auto* bytes = take(size);
+        return std::vector<char>(bytes, bytes + size);
+    }
+
+    ExtrinsicDataHelpers::Extrinsic readExtrinsic()
+    {
+        ExtrinsicDataHelpers::Extrinsic extrinsic;
+        extrinsic.t = read<std::array<float, 3>>();
+        extrinsic.q = read<std::array<float, 4>>();
+        extrinsic.valid = read<uint8_t>() != 0;
+        return extrinsic;
+    }
+
+    cv::Mat readImage()
+    {
+        const auto encoded = readBytes();
+        if (encoded.empty())
+        {
+            return cv::Mat();
+        }
+        return cv::imdecode(
+            std::vector<unsigned char>(encoded.begin(), encoded.end()), cv::IMREAD_UNCHANGED);
+    }
+
+private:
+    const char* take(const size_t size)
+    {
+        if (_position + size > _payload.size())
+        {
+            throw std::runtime_error("Corrupt record in session file");
+        }
+        const auto* data = _payload.data() + _position;
+        _position += size;
+        return data;
+    }
+
+    const std::vector<char>& _payload;
+    size_t _position = 0;
+};
+} // namespace
+
+SessionRecorder::SessionRecorder(const std::string& path) :
+    _startTime(std::chrono::steady_clock::now())
+{
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    _file.open(path, std::ios::binary);
+    if (!_file)
+    {
+        throw std::runtime_error("Unable to create session file " + path);
+    }
+    _file.write(sessionMagic, sizeof(sessionMagic));
+    _file.write(reinterpret_cast<const char*>(&sessionVersion), sizeof(sessionVersion));
+    _writer = std::thread(&SessionRecorder::writeLoop, this);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _recordQueued.notify_one();
+    _writer.join();
+}
+
+void SessionRecorder::recordCommand(const std::string& command, const bool isPartOfFrame)
+{
+    PayloadWriter writer;
+    writer.write(static_cast<uint8_t>(isPartOfFrame));
+    writer.writeBytes(command.data(), command.size());
+    enqueue(RecordType::Command, writer.takePayload());
+}
+
+void SessionRecorder::recordFrame(
+    const uint64_t frameId,
+    const std::vector<cv::Mat>& images,
+    const std::optional<ExtrinsicDataHelpers::Extrinsic>& externalExtrinsic,
+    const bool fetchLineModelImages,
+    const bool fetchTextureImage)
+{
+    PayloadWriter writer;
+    writer.write(frameId);
+    writer.write(static_cast<uint8_t>(fetchLineModelImages));
+    writer.write(static_cast<uint8_t>(fetchTextureImage));
+    writer.write(static_cast<uint8_t>(externalExtrinsic.has_value()));
+    if (externalExtrinsic.has_value())
+    {
+        writer.writeExtrinsic(externalExtrinsic.value());
+    }
+    writer.write(static_cast<uint32_t>(images.size()));
+    enqueue(RecordType::Frame, writer.takePayload(), images);
+}
+
+void SessionRecorder::recordResult(
+    const uint64_t frameId,
+    const bool deadlineExceeded,
+    const ExtrinsicDataHelpers::Extrinsic& extrinsic,
+    const std::chrono::nanoseconds latency,
+    const cv::Mat& textureImage)
+{
+    PayloadWriter writer;
+    writer.write(frameId);
+    writer.write(static_cast<uint8_t>(deadlineExceeded));
+    writer.writeExtrinsic(extrinsic);
+    writer.write(static_cast<int64_t>(latency.count()));
+    enqueue(RecordType::Result, writer.takePayload(), {textureImage});
+}
+
+void SessionRecorder::recordTexture(const uint64_t frameId, const cv::Mat& textureImage)
+{
+    PayloadWriter writer;
+    writer.write(frameId);
+    enqueue(RecordType::Texture, writer.takePayload(), {textureImage});
+}
+
+void SessionRecorder::recordPixelFormat(const ImageHelpers::PixelFormat format)
+{
+    PayloadWriter writer;
+    writer.write(static_cast<uint8_t>(format));
+    enqueue(RecordType::PixelFormat, writer.takePayload());
+}
+
+void SessionRecorder::enqueue(
+    const RecordType type,
+    std::vector<char> payload,
+    const std::vector<cv::Mat>& images)
+{
+    // Copied, since the caller may reuse the buffers before the record is written
+    std::vector<cv::Mat> imageCopies;
+    imageCopies.reserve(images.size());
+    for (const auto& image : images)
+    {
+        imageCopies.push_back(image.clone());
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto hasRoom = [this]()
+        { return _writeError || _pendingImageRecordCount < maxPendingImageRecords; };
+        if (!images.empty() && !hasRoom())
+        {
+            getStallCounter().increment();
+            _recordWritten.wait(lock, hasRoom);
+        }
+        if (_writeError)
+        {
+            std::rethrow_exception(_writeError);
+        }
+        if (!images.empty())
+        {
+            _pendingImageRecordCount++;
+        }
+        const auto timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - _startTime)
+                .count());
+        _pendingRecords.push_back({type, timestamp, std::move(payload), std::move(imageCopies)});
+    }
+    _recordQueued.notify_one();
+}
+
+void SessionRecorder::writeLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _recordQueued.wait(lock, [this]() { return _stopping || !_pendingRecords.empty(); });
+        if (_pendingRecords.empty())
+        {
+            return;
+        }
+        auto record = std::move(_pendingRecords.front());
+        _pendingRecords.pop_front();
+        // Flushed whenever the writer catches up, so that a crash loses as few records as
+        // possible
+        const auto isLastRecord = _pendingRecords.empty();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            write(record);
+            if (isLastRecord)
+            {
+                _file.flush();
+            }
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !_writeError)
+        {
+            _writeError = error;
+        }
+        if (!record.images.empty())
+        {
+            _pendingImageRecordCount--;
+        }
+        _recordWritten.notify_all();
+    }
+}
+
+void SessionRecorder::write(PendingRecord& record)
+{
+    PayloadWriter writer(std::move(record.payload));
+    for (const auto& image : record.images)
+    {
+        writer.writeImage(image);
+    }
+    const auto payload = writer.takePayload();
+    const auto payloadSize = static_cast<uint32_t>(payload.size());
+
+    // Only the writer thread accesses the file after construction
+    _file.write(reinterpret_cast<const char*>(&record.type), sizeof(record.type));
+    _file.write(reinterpret_cast<const char*>(&record.timestamp), sizeof(record.timestamp));
+    _file.write(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+    _file.write(payload.data(), payload.size());
+    if (!_file)
+    {
+        throw std::runtime_error("Unable to write to the session file");
+    }
+}
+
+SessionReader::SessionReader(const std::string& path) : _file(path, std::ios::binary)
+{
+    char magic[sizeof(sessionMagic)];
+    uint8_t version = 0;
+    _file.read(magic, sizeof(magic));
+    _file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!_file || std::memcmp(magic, sessionMagic, sizeof(magic)) != 0 || version == 0 ||
+        version > sessionVersion)
+    {
+        throw std::runtime_error(path + " is not a supported session file");
+    }
+}
+
+bool SessionReader::next(SessionRecord& record)
+{
+    RecordType type;
+    uint64_t timestamp;
+    uint32_t payloadSize;
+    _file.read(reinterpret_cast<char*>(&type), sizeof(type));
+    if (_file.eof())
+    {
+        return false;
+    }
+    _file.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp));
+    _file.read(reinterpret_cast<char*>(&payloadSize), sizeof(payloadSize));
+    std::vector<char> payload(payloadSize);
+    _file.read(payload.data(), payloadSize);
+    if (!_file)
+    {
+        throw std::runtime_error("Session file is truncated");
+    }
+
+    record = SessionRecord();
+    record.type = type;
+    record.timestamp = std::chrono::nanoseconds(timestamp);
+    PayloadReader reader(payload);
+    switch (type)
+    {
+        case RecordType::Command:
+        {
+            record.isPartOfFrame = reader.read<uint8_t>() != 0;
+            const auto command = reader.readBytes();
+            record.command.assign(command.begin(), command.end());
+            break;
+        }
+        case RecordType::Frame:
+        {
+            record.frameId = reader.read<uint64_t>();
+            record.fetchLineModelImages = reader.read<uint8_t>() != 0;
+            record.fetchTextureImage = reader.read<uint8_t>() != 0;
+            if (reader.read<uint8_t>() != 0)
+            {
+                record.externalExtrinsic = reader.readExtrinsic();
+            }
+            const auto imageCount = reader.read<uint32_t>();
+            for (uint32_t imageIdx = 0; imageIdx < imageCount; imageIdx++)
+            {
+                record.images.push_back(reader.readImage());
+            }
+            break;
+        }
+        case RecordType::Result:
+        {
+            record.frameId = reader.read<uint64_t>();
+            record.deadlineExceeded = reader.read<uint8_t>() != 0;
+            record.extrinsic = reader.readExtrinsic();
+            record.latency = std::chrono::nanoseconds(reader.read<int64_t>());
+            record.textureImage = reader.readImage();
+            break;
+        }
+        case RecordType::Texture:
+        {
+            record.frameId = reader.read<uint64_t>();
+            record.textureImage = reader.readImage();
+            break;
+        }
+        case RecordType::PixelFormat:
+        {
+            const auto format = reader.read<uint8_t>();
+            if (format > static_cast<uint8_t>(ImageHelpers::PixelFormat::BayerGBRG))
+            {
+                throw std::runtime_error("Unknown pixel format in session file");
+            }
+            record.pixelFormat = static_cast<ImageHelpers::PixelFormat>(format);
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown record type in session file");
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Recording/SessionRecord.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Recording
+{
+// Appends the records of a detector session to a session file. Thread-safe, since frames are
+// recorded on the submitting thread and results on the worker's thread. Recording only copies
+// the images; they are compressed and written on a thread of the recorder, so that recording
+// does not slow down the session it records. If the writer falls behind by maxPendingImageRecords
+// records with images, recording blocks until it catches up: dropping records would leave
+// results without their frame in the session, so the session is slowed down instead of being
+// recorded incompletely. Such stalls are counted by vldemo_recording_stalls_total.
+class SessionRecorder
+{
+public:
+    // Bounds the memory taken by the copied images
+    static constexpr size_t maxPendingImageRecords = 16;
+
+    explicit SessionRecorder(const std::string& path);
+    // Writes the remaining records
+    ~SessionRecorder();
+
+    void recordCommand(const std::string& command, const bool isPartOfFrame);
+    void recordFrame(
+        const uint64_t frameId,
+        const std::vector<cv::Mat>& images,
+        const std::optional<ExtrinsicDataHelpers::Extrinsic>& externalExtrinsic,
+        const bool fetchLineModelImages,
+        const bool fetchTextureImage);
+    void recordResult(
+        const uint64_t frameId,
+        const bool deadlineExceeded,
+        const ExtrinsicDataHelpers::Extrinsic& extrinsic,
+        const std::chrono::nanoseconds latency,
+        const cv::Mat& textureImage);
+    // A texture fetched after the frame with getTextureImage()
+    void recordTexture(const uint64_t frameId, const cv::Mat& textureImage);
+    void recordPixelFormat(const ImageHelpers::PixelFormat format);
+
+private:
+    struct PendingRecord
+    {
+        RecordType type;
+        uint64_t timestamp;
+        // The payload up to the images, which are appended when writing the record
+        std::vector<char> payload;
+        std::vector<cv::Mat> images;
+    };
+
+    void enqueue(
+        const RecordType type,
+        std::vector<char> payload,
+        const std::vector<cv::Mat>& images = {});
+    void writeLoop();
+    void write(PendingRecord& record);
+
+    std::mutex _mutex;
+    std::condition_variable _recordQueued;
+    std::condition_variable _recordWritten;
+    std::deque<PendingRecord> _pendingRecords;
+    size_t _pendingImageRecordCount = 0;
+    bool _stopping = false;
+    // Raised by the next recording call, since the records are written on another thread
+    std::exception_ptr _writeError;
+    std::ofstream _file;
+    std::chrono::steady_clock::time_point _startTime;
+    std::thread _writer;
+};
+
+// Reads the records of a session file one after the other
+class SessionReader
+{
+public:
+    explicit SessionReader(const std::string& path);
+
+    // Returns false at the end of the file
+    bool next(SessionRecord& record);
+
+private:
+    std::ifstream _file;
+};
+} // namespace Recording
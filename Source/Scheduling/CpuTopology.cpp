@@ -0,0 +1,269 @@
+#include <Scheduling/CpuTopology.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace
+{
+const std::filesystem::path sysfsCpuDir = "/sys/devices/system/cpu";
+const std::filesystem::path sysfsNodeDir = "/sys/devices/system/node";
+
+std::string readFirstLine(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+unsigned int readUnsigned(const std::filesystem::path& path, const unsigned int fallback)
+{
+    const auto line = readFirstLine(path);
+    return line.empty() ? fallback : static_cast<unsigned int>(std::stoul(line));
+}
+
+// Parses the kernel's list format, e.g. "0-3,8,10-11"
+Scheduling::CpuSet parseCpuList(const std::string& list)
+{
+    Scheduling::CpuSet cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty())
+        {
+            continue;
+        }
+        const auto dash = range.find('-');
+        const auto first = static_cast<unsigned int>(std::stoul(range.substr(0, dash)));
+        const auto last = dash == std::string::npos
+                              ? first
+                              : static_cast<unsigned int>(std::stoul(range.substr(dash + 1)));
+        for (auto cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+Scheduling::CpuTopology getFallbackTopology()
+{
+    Scheduling::CpuTopology topology;
+    const auto cpuCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int cpu = 0; cpu < cpuCount; cpu++)
+    {
+        topology.cpus.push_back({cpu, cpu, 0, 0});
+    }
+    return topology;
+}
+} // namespace
+
+namespace Scheduling
+{
+CpuSet CpuTopology::getCpusOfNumaNode(const unsigned int numaNode) const
+{
+    std::vector<LogicalCpu> nodeCpus;
+    std::copy_if(
+        cpus.begin(),
+        cpus.end(),
+        std::back_inserter(nodeCpus),
+        [numaNode](const LogicalCpu& cpu) { return cpu.numaNode == numaNode; });
+    std::sort(
+        nodeCpus.begin(),
+        nodeCpus.end(),
+        [](const LogicalCpu& a, const LogicalCpu& b)
+        {
+            return std::tie(a.packageId, a.coreId, a.cpuId) <
+                   std::tie(b.packageId, b.coreId, b.cpuId);
+        });
+
+    CpuSet result;
+    for (const auto& cpu : nodeCpus)
+    {
+        result.push_back(cpu.cpuId);
+    }
+    return result;
+}
+
+CpuTopology readCpuTopology()
+{
+    const auto onlineCpus = parseCpuList(readFirstLine(sysfsCpuDir / "online"));
+    if (onlineCpus.empty())
+    {
+        return getFallbackTopology();
+    }
+
+    // Node ids may have gaps, e.g. node0 and node2, so the directory is listed instead of
+    // probing ids in sequence
+    std::map<unsigned int, unsigned int> numaNodeOfCpu;
+    std::set<unsigned int> numaNodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(sysfsNodeDir, error))
+    {
+        const auto name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            !std::all_of(
+                name.begin() + 4,
+                name.end(),
+                [](const unsigned char c) { return std::isdigit(c) != 0; }))
+        {
+            continue;
+        }
+        const auto node = static_cast<unsigned int>(std::stoul(name.substr(4)));
+        for (const auto cpu : parseCpuList(readFirstLine(entry.path() / "cpulist")))
+        {
+            numaNodeOfCpu[cpu] = node;
+            numaNodes.insert(node);
+        }
+    }
+
+    CpuTopology topology;
+    if (!numaNodes.empty())
+    {
+        topology.numaNodes.assign(numaNodes.begin(), numaNodes.end());
+    }
+    for (const auto cpu : onlineCpus)
+    {
+        const auto topologyDir = sysfsCpuDir / ("cpu" + std::to_string(cpu)) / "topology";
+        const auto node = numaNodeOfCpu.find(cpu);
+        topology.cpus.push_back(
+            {cpu,
+             readUnsigned(topologyDir / "core_id", cpu),
+             readUnsigned(topologyDir / "physical_package_id", 0),
+             node != numaNodeOfCpu.end() ? node->second : topology.numaNodes.front()});
+    }
+    return topology;
+}
+
+ThreadBudget planThreadBudget(
+    const CpuTopology& topology,
+    const size_t detectorCount,
+    const size_t loaderCpuCount)
+{
+    if (detectorCount == 0 || loaderCpuCount == 0)
+    {
+        throw std::runtime_error("Cannot plan thread budget without detectors or loader CPUs");
+    }
+
+    const auto nodeCount = topology.numaNodes.size();
+    std::vector<std::vector<size_t>> slotsOfNode(nodeCount);
+    for (size_t slotIdx = 0; slotIdx < detectorCount; slotIdx++)
+    {
+        slotsOfNode[slotIdx % nodeCount].push_back(slotIdx);
+    }
+
+    ThreadBudget budget;
+    budget.slots.resize(detectorCount);
+    for (size_t nodeIdx = 0; nodeIdx < nodeCount; nodeIdx++)
+    {
+        const auto node = topology.numaNodes[nodeIdx];
+        const auto& slotIndices = slotsOfNode[nodeIdx];
+        if (slotIndices.empty())
+        {
+            continue;
+        }
+        const auto nodeCpus = topology.getCpusOfNumaNode(node);
+        const auto cpusPerSlot = nodeCpus.size() / slotIndices.size();
+        if (cpusPerSlot <= loaderCpuCount)
+        {
+            throw std::runtime_error(
+                "Not enough CPUs on NUMA node " + std::to_string(node) + " for " +
+                std::to_string(slotIndices.size()) + " detectors");
+        }
+        for (size_t i = 0; i < slotIndices.size(); i++)
+        {
+            auto& slot = budget.slots[slotIndices[i]];
+            const auto firstCpu = nodeCpus.begin() + i * cpusPerSlot;
+            slot.numaNode = node;
+            slot.loaderCpus.assign(firstCpu, firstCpu + loaderCpuCount);
+            slot.detectorCpus.assign(firstCpu + loaderCpuCount, firstCpu + cpusPerSlot);
+        }
+    }
+
+    // Loading, conversion and visualization run on the loader threads
+    budget.openCVThreads = static_cast<int>(loaderCpuCount);
+    return budget;
+}
+
+bool pinCurrentThread(const CpuSet& cpus)
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const auto cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        CPU_SET(cpu, &cpuSet);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (const auto cpu : cpus)
+    {
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+        {
+            return false;
+        }
+        mask |= DWORD_PTR(1) << cpu;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+std::string describe(const CpuSet& cpus)
+{
+    std::string descr = "[";
+    for (size_t i = 0; i < cpus.size(); i++)
+    {
+        descr += (i > 0 ? ", " : "") + std::to_string(cpus[i]);
+    }
+    return descr + "]";
+}
+
+ScopedOpenCVThreads::ScopedOpenCVThreads(const int threadCount) :
+    _previousThreadCount(cv::getNumThreads())
+{
+    cv::setNumThreads(threadCount);
+}
+
+ScopedOpenCVThreads::~ScopedOpenCVThreads()
+{
+    cv::setNumThreads(_previousThreadCount);
+}
+
+std::vector<cv::Mat> toLocalFrame(const std::vector<cv::Mat>& frame)
+{
+    std::vector<cv::Mat> localFrame;
+    localFrame.reserve(frame.size());
+    for (const auto& image : frame)
+    {
+        localFrame.push_back(image.clone());
+    }
+    return localFrame;
+}
+} // namespace Scheduling
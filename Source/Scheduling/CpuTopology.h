@@ -0,0 +1,81 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Scheduling
+{
+using CpuSet = std::vector<unsigned int>;
+
+struct LogicalCpu
+{
+    unsigned int cpuId;
+    unsigned int coreId;
+    unsigned int packageId;
+    unsigned int numaNode;
+};
+
+struct CpuTopology
+{
+    std::vector<LogicalCpu> cpus;
+    // Ids of the NUMA nodes with CPUs in ascending order, which need not be contiguous
+    std::vector<unsigned int> numaNodes = {0};
+
+    // Logical CPUs of the node, hyper-threading siblings are adjacent
+    CpuSet getCpusOfNumaNode(const unsigned int numaNode) const;
+};
+
+// Core sets of one detector and the thread loading its frames. Both are on the same NUMA
+// node, so that frames decoded by the loader are allocated in memory local to the detector.
+struct DetectorSlot
+{
+    unsigned int numaNode = 0;
+    CpuSet detectorCpus;
+    CpuSet loaderCpus;
+};
+
+struct ThreadBudget
+{
+    std::vector<DetectorSlot> slots;
+    // cv::setNumThreads() applies to the whole process, so there is only one limit for all
+    // stages. It matches the loader CPUs, which the stages using OpenCV's pool run on.
+    int openCVThreads = 1;
+};
+
+// Reads the topology from sysfs on Linux. Elsewhere all CPUs are reported on a single node.
+CpuTopology readCpuTopology();
+
+// Distributes the detectors round robin over the NUMA nodes and splits the CPUs of each node
+// between its detectors, reserving loaderCpuCount CPUs per detector for loading frames
+ThreadBudget planThreadBudget(
+    const CpuTopology& topology,
+    const size_t detectorCount,
+    const size_t loaderCpuCount = 1);
+
+// Returns false if pinning is not supported on this platform or the CPU set is invalid
+bool pinCurrentThread(const CpuSet& cpus);
+
+std::string describe(const CpuSet& cpus);
+
+// Limits the threads OpenCV uses for parallel regions and restores the previous value on
+// destruction. With most OpenCV parallel backends the limit applies to the whole process, so it
+// cannot differ between concurrently running stages.
+class ScopedOpenCVThreads
+{
+public:
+    explicit ScopedOpenCVThreads(const int threadCount);
+    ~ScopedOpenCVThreads();
+
+    ScopedOpenCVThreads(const ScopedOpenCVThreads&) = delete;
+    ScopedOpenCVThreads& operator=(const ScopedOpenCVThreads&) = delete;
+
+private:
+    int _previousThreadCount;
+};
+
+// Deep copies the frame on the calling thread. Memory is placed on first touch, so for a pinned
+// thread the copy is allocated on the thread's NUMA node.
+std::vector<cv::Mat> toLocalFrame(const std::vector<cv::Mat>& frame);
+} // namespace Scheduling
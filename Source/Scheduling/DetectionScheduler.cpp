@@ -0,0 +1,312 @@
+#include <Scheduling/DetectionScheduler.h>
+
+#include <Metrics/MetricsRegistry.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+// Weight of the latest service time in the estimate
+constexpr double serviceTimeSmoothing = 0.2;
+
+Metrics::Counter& getOutcomeCounter(
+    const Scheduling::PriorityClass priority,
+    const std::string& outcome)
+{
+    return Metrics::Registry::global().counter(
+        "vldemo_scheduler_requests_total",
+        "Requests finished by the detection scheduler",
+        "class=\"" + to_string(priority) + "\",outcome=\"" + outcome + "\"");
+}
+} // namespace
+
+namespace Scheduling
+{
+std::string to_string(const PriorityClass priority)
+{
+    return priority == PriorityClass::Live ? "live" : "batch";
+}
+
+double ClassStatistics::getMissRate() const
+{
+    const auto finished = completedInTime + missed + rejected;
+    return finished > 0 ? static_cast<double>(missed + rejected) / finished : 0.0;
+}
+
+bool DetectionScheduler::LaterDeadline::operator()(
+    const QueuedRequest& a,
+    const QueuedRequest& b) const
+{
+    if (a.deadline != b.deadline)
+    {
+        return a.deadline > b.deadline;
+    }
+    return a.sequenceNumber > b.sequenceNumber;
+}
+
+DetectionScheduler::DetectionScheduler(
+    std::vector<std::unique_ptr<MultiViewDetector>> detectors) :
+    _detectors(std::move(detectors))
+{
+    if (_detectors.empty())
+    {
+        throw std::runtime_error("Detection scheduler needs at least one detector");
+    }
+    for (auto& detector : _detectors)
+    {
+        _dispatchers.emplace_back(&DetectionScheduler::dispatchLoop, this, std::ref(*detector));
+    }
+}
+
+DetectionScheduler::~DetectionScheduler()
+{
+    Queue abandoned;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        for (auto* queue : {&_liveQueue, &_batchQueue})
+        {
+            std::move(queue->begin(), queue->end(), std::back_inserter(abandoned));
+            queue->clear();
+        }
+    }
+    _requestsAvailable.notify_all();
+    for (auto& dispatcher : _dispatchers)
+    {
+        dispatcher.join();
+    }
+    for (auto& queued : abandoned)
+    {
+        queued.promise->set_exception(std::make_exception_ptr(
+            std::runtime_error("Detection scheduler stopped before the request was started")));
+    }
+}
+
+std::future<DetectionResult>
+    DetectionScheduler::submit(DetectionRequest request, const PriorityClass priority)
+{
+    std::vector<DetectionRequest> requests;
+    requests.push_back(std::move(request));
+    return std::move(submitBatch(std::move(requests), priority).front());
+}
+
+std::vector<std::future<DetectionResult>>
+    DetectionScheduler::submitBatch(std::vector<DetectionRequest> requests)
+{
+    return submitBatch(std::move(requests), PriorityClass::Batch);
+}
+
+std::vector<std::future<DetectionResult>> DetectionScheduler::submitBatch(
+    std::vector<DetectionRequest> requests,
+    const PriorityClass priority)
+{
+    std::vector<std::future<DetectionResult>> results;
+    std::vector<QueuedRequest> rejected;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping)
+        {
+            throw std::runtime_error("Detection scheduler is stopping");
+        }
+        const auto now = Clock::now();
+        auto& queue = getQueue(priority);
+        auto& statistics = getMutableStatistics(priority);
+        for (auto& request : requests)
+        {
+            QueuedRequest queued;
+            queued.deadline = request.deadline.value_or(Clock::time_point::max());
+            queued.onResult = std::move(request.onResult);
+            queued.request = std::move(request);
+            queued.priority = priority;
+            queued.sequenceNumber = _nextSequenceNumber++;
+            queued.promise = std::make_shared<std::promise<DetectionResult>>();
+            results.push_back(queued.promise->get_future());
+            statistics.submitted++;
+
+            if (!canMeetDeadline(queued.deadline, now))
+            {
+                statistics.rejected++;
+                rejected.push_back(std::move(queued));
+                continue;
+            }
+            queue.push_back(std::move(queued));
+            std::push_heap(queue.begin(), queue.end(), LaterDeadline());
+        }
+    }
+    _requestsAvailable.notify_all();
+
+    DetectionResult rejection;
+    rejection.status = DetectionStatus::Rejected;
+    for (auto& queued : rejected)
+    {
+        getOutcomeCounter(priority, "rejected").increment();
+        deliver(queued, rejection);
+    }
+    return results;
+}
+
+ClassStatistics DetectionScheduler::getStatistics(const PriorityClass priority) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return priority == PriorityClass::Live ? _liveStatistics : _batchStatistics;
+}
+
+std::chrono::steady_clock::duration DetectionScheduler::getServiceTimeEstimate() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(_serviceTimeEstimateSeconds));
+}
+
+void DetectionScheduler::dispatchLoop(MultiViewDetector& detector)
+{
+    DetectionResult rejection;
+    rejection.status = DetectionStatus::Rejected;
+    while (true)
+    {
+        QueuedRequest next;
+        std::vector<QueuedRequest> rejected;
+        bool hasNext;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _requestsAvailable.wait(
+                lock,
+                [this]() { return _stopping || !_liveQueue.empty() || !_batchQueue.empty(); });
+            if (_stopping)
+            {
+                return;
+            }
+            hasNext = popNext(next, rejected);
+        }
+        for (auto& queued : rejected)
+        {
+            getOutcomeCounter(queued.priority, "rejected").increment();
+            deliver(queued, rejection);
+        }
+        if (!hasNext)
+        {
+            continue;
+        }
+
+        const auto startTime = Clock::now();
+        DetectionResult result;
+        try
+        {
+            result = detector.submit(std::move(next.request)).get();
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                getMutableStatistics(next.priority).failed++;
+            }
+            getOutcomeCounter(next.priority, "failed").increment();
+            next.promise->set_exception(std::current_exception());
+            continue;
+        }
+        const auto finishTime = Clock::now();
+
+        const auto failed = result.status == DetectionStatus::CommandFailed;
+        const auto inTime =
+            result.status == DetectionStatus::Completed && finishTime <= next.deadline;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            updateServiceTimeEstimate(finishTime - startTime);
+            auto& statistics = getMutableStatistics(next.priority);
+            if (failed)
+            {
+                statistics.failed++;
+            }
+            else
+            {
+                (inTime ? statistics.completedInTime : statistics.missed)++;
+            }
+        }
+        getOutcomeCounter(next.priority, failed ? "failed" : inTime ? "completed" : "missed")
+            .increment();
+        deliver(next, result);
+    }
+}
+
+bool DetectionScheduler::popNext(QueuedRequest& next, std::vector<QueuedRequest>& rejected)
+{
+    const auto now = Clock::now();
+    for (auto* queue : {&_liveQueue, &_batchQueue})
+    {
+        while (!queue->empty())
+        {
+            std::pop_heap(queue->begin(), queue->end(), LaterDeadline());
+            auto queued = std::move(queue->back());
+            queue->pop_back();
+            if (canMeetDeadline(queued.deadline, now))
+            {
+                next = std::move(queued);
+                return true;
+            }
+            getMutableStatistics(queued.priority).rejected++;
+            rejected.push_back(std::move(queued));
+        }
+    }
+    return false;
+}
+
+bool DetectionScheduler::canMeetDeadline(
+    const Clock::time_point deadline,
+    const Clock::time_point now) const
+{
+    if (deadline == Clock::time_point::max())
+    {
+        return true;
+    }
+    return now + std::chrono::duration_cast<Clock::duration>(
+                     std::chrono::duration<double>(_serviceTimeEstimateSeconds)) <=
+           deadline;
+}
+
+void DetectionScheduler::updateServiceTimeEstimate(const Clock::duration serviceTime)
+{
+    const auto seconds = std::chrono::duration<double>(serviceTime).count();
+    _serviceTimeEstimateSeconds =
+        _serviceTimeEstimateSeconds == 0.0
+            ? seconds
+            : serviceTimeSmoothing * seconds +
+                  (1.0 - serviceTimeSmoothing) * _serviceTimeEstimateSeconds;
+}
+
+void DetectionScheduler::deliver(QueuedRequest& queued, const DetectionResult& result)
+{
+    try
+    {
+        if (queued.onResult)
+        {
+            queued.onResult(result);
+        }
+        queued.promise->set_value(result);
+    }
+    catch (...)
+    {
+        queued.promise->set_exception(std::current_exception());
+    }
+}
+
+DetectionScheduler::Queue& DetectionScheduler::getQueue(const PriorityClass priority)
+{
+    return priority == PriorityClass::Live ? _liveQueue : _batchQueue;
+}
+
+ClassStatistics& DetectionScheduler::getMutableStatistics(const PriorityClass priority)
+{
+    return priority == PriorityClass::Live ? _liveStatistics : _batchStatistics;
+}
+
+std::string to_string(const ClassStatistics& statistics)
+{
+    return std::to_string(statistics.submitted) + " submitted, " +
+           std::to_string(statistics.completedInTime) + " in time, " +
+           std::to_string(statistics.missed) + " missed, " +
+           std::to_string(statistics.rejected) + " rejected, " +
+           std::to_string(statistics.failed) + " failed, miss rate: " +
+           std::to_string(statistics.getMissRate() * 100.0) + " %";
+}
+} // namespace Scheduling
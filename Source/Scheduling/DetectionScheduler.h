@@ -0,0 +1,113 @@
+#pragma once
+
+#include <MultiViewDetector.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Scheduling
+{
+enum class PriorityClass
+{
+    // Line-side requests with tight latency budgets
+    Live,
+    // Background reprocessing, only runs while no live request is waiting
+    Batch
+};
+
+std::string to_string(const PriorityClass priority);
+
+struct ClassStatistics
+{
+    uint64_t submitted = 0;
+    uint64_t completedInTime = 0;
+    // Processed, but the result was not available before the deadline
+    uint64_t missed = 0;
+    // Not started, since the deadline could not be met anymore
+    uint64_t rejected = 0;
+    uint64_t failed = 0;
+
+    // Share of missed and rejected requests among the finished requests with an outcome
+    double getMissRate() const;
+};
+
+std::string to_string(const ClassStatistics& statistics);
+
+// Distributes detection requests to a set of detectors, one frame at a time each. Live requests
+// always run before batch requests; within a class, the request with the earliest deadline runs
+// first (requests without deadline last, in submission order). Since a batch is split into one
+// request per frame, live requests preempt it at the next frame boundary.
+// A request whose deadline cannot be met according to the recent service times is rejected
+// early with DetectionStatus::Rejected instead of occupying a detector.
+class DetectionScheduler
+{
+public:
+    explicit DetectionScheduler(std::vector<std::unique_ptr<MultiViewDetector>> detectors);
+    // Requests which have not been started yet fail with an exception
+    ~DetectionScheduler();
+
+    std::future<DetectionResult> submit(DetectionRequest request, const PriorityClass priority);
+    // Each frame of a batch is scheduled as a batch request of its own
+    std::vector<std::future<DetectionResult>> submitBatch(std::vector<DetectionRequest> requests);
+
+    ClassStatistics getStatistics(const PriorityClass priority) const;
+    // Average duration of a request on a detector, 0 before the first request has finished
+    std::chrono::steady_clock::duration getServiceTimeEstimate() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct QueuedRequest
+    {
+        DetectionRequest request;
+        // Taken from the request, since the scheduler delivers the result itself
+        std::function<void(const DetectionResult&)> onResult;
+        PriorityClass priority;
+        Clock::time_point deadline;
+        uint64_t sequenceNumber;
+        std::shared_ptr<std::promise<DetectionResult>> promise;
+    };
+
+    // Heap order (std::push_heap) with the earliest deadline on top
+    struct LaterDeadline
+    {
+        bool operator()(const QueuedRequest& a, const QueuedRequest& b) const;
+    };
+
+    using Queue = std::vector<QueuedRequest>;
+
+    std::vector<std::future<DetectionResult>>
+        submitBatch(std::vector<DetectionRequest> requests, const PriorityClass priority);
+    void dispatchLoop(MultiViewDetector& detector);
+    // Takes the next request which can still meet its deadline and moves the ones in front of
+    // it which cannot to rejected. Expects _mutex to be locked.
+    bool popNext(QueuedRequest& next, std::vector<QueuedRequest>& rejected);
+    bool canMeetDeadline(const Clock::time_point deadline, const Clock::time_point now) const;
+    void updateServiceTimeEstimate(const Clock::duration serviceTime);
+    static void deliver(QueuedRequest& queued, const DetectionResult& result);
+
+    Queue& getQueue(const PriorityClass priority);
+    ClassStatistics& getMutableStatistics(const PriorityClass priority);
+
+    std::vector<std::unique_ptr<MultiViewDetector>> _detectors;
+    mutable std::mutex _mutex;
+    std::condition_variable _requestsAvailable;
+    Queue _liveQueue;
+    Queue _batchQueue;
+    ClassStatistics _liveStatistics;
+    ClassStatistics _batchStatistics;
+    uint64_t _nextSequenceNumber = 0;
+    // Exponentially weighted moving average
+    double _serviceTimeEstimateSeconds = 0.0;
+    bool _stopping = false;
+    std::vector<std::thread> _dispatchers;
+};
+} // namespace Scheduling
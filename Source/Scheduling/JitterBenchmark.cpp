@@ -0,0 +1,135 @@
+#include <Scheduling/JitterBenchmark.h>
+
+#include <Scheduling/CpuTopology.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+namespace
+{
+Scheduling::LatencyStatistics computeStatistics(std::vector<double> latenciesMs)
+{
+    Scheduling::LatencyStatistics statistics;
+    if (latenciesMs.empty())
+    {
+        return statistics;
+    }
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+
+    const auto count = static_cast<double>(latenciesMs.size());
+    const auto mean = std::accumulate(latenciesMs.begin(), latenciesMs.end(), 0.0) / count;
+    double squaredDeviations = 0.0;
+    for (const auto latency : latenciesMs)
+    {
+        squaredDeviations += (latency - mean) * (latency - mean);
+    }
+    const auto percentile = [&latenciesMs](const double p)
+    {
+        const auto idx = static_cast<size_t>(std::ceil(p * latenciesMs.size())) - 1;
+        return latenciesMs[std::min(idx, latenciesMs.size() - 1)];
+    };
+
+    statistics.frameCount = latenciesMs.size();
+    statistics.meanMs = mean;
+    statistics.stdDevMs = std::sqrt(squaredDeviations / count);
+    statistics.p50Ms = percentile(0.5);
+    statistics.p99Ms = percentile(0.99);
+    statistics.maxMs = latenciesMs.back();
+    return statistics;
+}
+} // namespace
+
+namespace Scheduling
+{
+LatencyStatistics runJitterBenchmark(
+    const JitterBenchmarkConfig& config,
+    const DetectorFactory& createDetector,
+    const RequestFactory& createRequest)
+{
+    std::optional<ThreadBudget> budget;
+    std::optional<ScopedOpenCVThreads> openCVThreads;
+    if (config.pinThreads)
+    {
+        budget = planThreadBudget(readCpuTopology(), config.detectorCount);
+        openCVThreads.emplace(budget->openCVThreads);
+    }
+
+    std::vector<std::unique_ptr<MultiViewDetector>> detectors;
+    for (size_t detectorIdx = 0; detectorIdx < config.detectorCount; detectorIdx++)
+    {
+        detectors.push_back(createDetector());
+    }
+
+    std::mutex latenciesMutex;
+    std::vector<double> latenciesMs;
+    std::vector<std::thread> loaders;
+    for (size_t detectorIdx = 0; detectorIdx < config.detectorCount; detectorIdx++)
+    {
+        loaders.emplace_back(
+            [&, detectorIdx]()
+            {
+                auto& detector = *detectors[detectorIdx];
+                if (budget.has_value())
+                {
+                    const auto& slot = budget->slots[detectorIdx];
+                    auto pinned = false;
+                    if (detector.hasWorkerThread())
+                    {
+                        pinned = detector.pinWorkerThread(slot.detectorCpus) &&
+                                 pinCurrentThread(slot.loaderCpus);
+                    }
+                    else
+                    {
+                        // The worker's calls run on this thread, which therefore gets the cores
+                        // of both
+                        auto cpus = slot.detectorCpus;
+                        cpus.insert(cpus.end(), slot.loaderCpus.begin(), slot.loaderCpus.end());
+                        pinned = pinCurrentThread(cpus);
+                    }
+                    if (!pinned)
+                    {
+                        std::cout << "Could not pin detector " << detectorIdx << "\n";
+                    }
+                }
+
+                std::vector<double> localLatenciesMs;
+                for (size_t frameIdx = 0; frameIdx < config.framesPerDetector; frameIdx++)
+                {
+                    auto request = createRequest(frameIdx);
+                    request.frame = toLocalFrame(request.frame);
+
+                    const auto startTime = std::chrono::steady_clock::now();
+                    detector.submit(std::move(request)).get();
+                    localLatenciesMs.push_back(std::chrono::duration<double, std::milli>(
+                                                   std::chrono::steady_clock::now() - startTime)
+                                                   .count());
+                }
+
+                std::lock_guard<std::mutex> lock(latenciesMutex);
+                latenciesMs.insert(
+                    latenciesMs.end(), localLatenciesMs.begin(), localLatenciesMs.end());
+            });
+    }
+    for (auto& loader : loaders)
+    {
+        loader.join();
+    }
+    return computeStatistics(std::move(latenciesMs));
+}
+
+std::string to_string(const LatencyStatistics& statistics)
+{
+    return std::to_string(statistics.frameCount) +
+           " frames, mean: " + std::to_string(statistics.meanMs) +
+           " ms, std dev: " + std::to_string(statistics.stdDevMs) +
+           " ms, p50: " + std::to_string(statistics.p50Ms) +
+           " ms, p99: " + std::to_string(statistics.p99Ms) +
+           " ms, max: " + std::to_string(statistics.maxMs) + " ms";
+}
+} // namespace Scheduling
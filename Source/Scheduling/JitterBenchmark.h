@@ -0,0 +1,42 @@
+#pragma once
+
+#include <MultiViewDetector.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace Scheduling
+{
+struct JitterBenchmarkConfig
+{
+    size_t detectorCount = 2;
+    size_t framesPerDetector = 50;
+    bool pinThreads = true;
+};
+
+struct LatencyStatistics
+{
+    size_t frameCount = 0;
+    double meanMs = 0.0;
+    double stdDevMs = 0.0;
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+using DetectorFactory = std::function<std::unique_ptr<MultiViewDetector>()>;
+using RequestFactory = std::function<DetectionRequest(const size_t requestIdx)>;
+
+// Runs detectorCount detectors concurrently, each fed by its own loader thread, and measures the
+// latency of every frame. With pinThreads each detector and its loader are pinned to a core set
+// according to planThreadBudget() and OpenCV's thread count is capped accordingly. Detectors
+// without a worker thread of their own run the worker's calls on the loader, which is then
+// pinned to the cores of both.
+LatencyStatistics runJitterBenchmark(
+    const JitterBenchmarkConfig& config,
+    const DetectorFactory& createDetector,
+    const RequestFactory& createRequest);
+
+std::string to_string(const LatencyStatistics& statistics);
+} // namespace Scheduling
@@ -0,0 +1,106 @@
+#include <Texture/TextureAccumulator.h>
+
+#include <Helpers/DataProcessingHelpers.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+TextureAccumulator::TextureAccumulator(const TextureMappingConfig& config) : _config(config)
+{
+    if (_config.width <= 0 || _config.height <= 0)
+    {
+        throw std::runtime_error("Invalid texture size in texture mapping config");
+    }
+    reset();
+}
+
+void TextureAccumulator::reset()
+{
+    _meanColor = cv::Mat::zeros(_config.height, _config.width, CV_32FC3);
+    _weightSum = cv::Mat::zeros(_config.height, _config.width, CV_32FC1);
+    _frameCount = 0;
+}
+
+float TextureAccumulator::getTexelWeight(const cv::Vec3b& texel, const float score) const
+{
+    const auto maxValue = std::max({texel[0], texel[1], texel[2]});
+    const auto minValue = std::min({texel[0], texel[1], texel[2]});
+    if (maxValue == 0 || score < _config.minScoreForOptimization)
+    {
+        return 0.0f;
+    }
+    const auto isWhite = minValue / 255.0f >= _config.whiteOutlierMinValue;
+    return isWhite ? std::min(score, _config.whiteOutlierMaxScore) : score;
+}
+
+void TextureAccumulator::accumulate(const cv::Mat& texture, const cv::Mat& scores)
+{
+    accumulate(texture, scores, 1.0f);
+}
+
+void TextureAccumulator::accumulate(const cv::Mat& texture, const float frameScore)
+{
+    accumulate(texture, cv::Mat(), frameScore);
+}
+
+void TextureAccumulator::accumulate(
+    const cv::Mat& texture,
+    const cv::Mat& scores,
+    const float defaultScore)
+{
+    if (texture.rows != _config.height || texture.cols != _config.width ||
+        texture.type() != CV_8UC3)
+    {
+        throw std::runtime_error("Texture does not match the size of the texture mapping config");
+    }
+    if (!scores.empty() && (scores.size() != texture.size() || scores.type() != CV_32FC1))
+    {
+        throw std::runtime_error("Texel scores do not match the texture");
+    }
+
+    for (int row = 0; row < texture.rows; row++)
+    {
+        const auto* texelRow = texture.ptr<cv::Vec3b>(row);
+        const auto* scoreRow = scores.empty() ? nullptr : scores.ptr<float>(row);
+        auto* meanRow = _meanColor.ptr<cv::Vec3f>(row);
+        auto* weightRow = _weightSum.ptr<float>(row);
+        for (int col = 0; col < texture.cols; col++)
+        {
+            const auto weight =
+                getTexelWeight(texelRow[col], scoreRow ? scoreRow[col] : defaultScore);
+            if (weight <= 0.0f)
+            {
+                continue;
+            }
+            weightRow[col] += weight;
+            const auto ratio = weight / weightRow[col];
+            for (int channel = 0; channel < 3; channel++)
+            {
+                meanRow[col][channel] += ratio * (texelRow[col][channel] - meanRow[col][channel]);
+            }
+        }
+    }
+    _frameCount++;
+}
+
+cv::Mat TextureAccumulator::getAtlas() const
+{
+    cv::Mat atlas;
+    _meanColor.convertTo(atlas, CV_8UC3);
+    return atlas;
+}
+
+cv::Mat TextureAccumulator::getConfidence() const
+{
+    return _weightSum.clone();
+}
+
+size_t TextureAccumulator::getFrameCount() const
+{
+    return _frameCount;
+}
+
+void TextureAccumulator::writeAtlas(const std::string& path) const
+{
+    DataProcessingHelpers::writeImage(getAtlas(), path);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Texture/TextureMappingConfig.h>
+
+#include <opencv2/core.hpp>
+
+#include <string>
+
+// Fuses the textures extracted from consecutive frames into one atlas. Every texel keeps a
+// running weighted mean of its colour and the sum of its weights (the confidence), so memory
+// stays constant regardless of the number of frames.
+class TextureAccumulator
+{
+public:
+    explicit TextureAccumulator(const TextureMappingConfig& config);
+
+    // Folds a BGR texture as returned by MultiViewDetector::getTextureImage() into the atlas.
+    // Black texels are treated as not mapped. The optional scores (CV_32FC1, between 0 and 1)
+    // rate each texel; texels scoring below minScoreForOptimization are ignored and white texels
+    // are capped at whiteOutlierMaxScore.
+    void accumulate(const cv::Mat& texture, const cv::Mat& scores = cv::Mat());
+    // Rates all texels of the texture with the same score, e.g. derived from the pose validity
+    // of the frame. Frames scoring below minScoreForOptimization are skipped entirely.
+    void accumulate(const cv::Mat& texture, const float frameScore);
+
+    // BGR atlas, texels never mapped are black
+    cv::Mat getAtlas() const;
+    // Accumulated weight per texel (CV_32FC1)
+    cv::Mat getConfidence() const;
+    size_t getFrameCount() const;
+
+    void writeAtlas(const std::string& path) const;
+    void reset();
+
+private:
+    float getTexelWeight(const cv::Vec3b& texel, const float score) const;
+    void accumulate(const cv::Mat& texture, const cv::Mat& scores, const float defaultScore);
+
+    TextureMappingConfig _config;
+    cv::Mat _meanColor;
+    cv::Mat _weightSum;
+    size_t _frameCount = 0;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+struct TextureMappingConfig
+{
+    enum BRIGHTNESS_CORRECTION_METHOD
+    {
+        EXPLICIT_CONTRAST_MEAN = 0,
+        TOTAL_LEAST_SQUARES = 1
+    };
+
+    BRIGHTNESS_CORRECTION_METHOD method = TOTAL_LEAST_SQUARES;
+    // threshold values between 0 and 1
+    float minScoreForOptimization = 0.4f;
+    float whiteOutlierMaxScore = 0.8f;
+    float whiteOutlierMinValue = 0.8f;
+    // relevant only for EXPLICIT_CONTRAST_MEAN method
+    int referenceFrameID = 0;
+
+    int stride = 3;
+    int width = 1024;
+    int height = 1024;
+    bool verbose = false;
+
+    nlohmann::json toJson() const
+    {
+        nlohmann::json config;
+        config["method"] = static_cast<int>(method);
+        config["minScoreForOptimization"] = minScoreForOptimization;
+        config["whiteOutlierMaxScore"] = whiteOutlierMaxScore;
+        config["whiteOutlierMinValue"] = whiteOutlierMinValue;
+        config["referenceFrameID"] = referenceFrameID;
+        config["stride"] = stride;
+        config["width"] = width;
+        config["height"] = height;
+        config["verbose"] = verbose;
+        return config;
+    }
+};
@@ -0,0 +1,139 @@
+#include <Backends/StandInWorkerBackend.h>
+#include <MultiViewDetector.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Counts the heap allocations of MultiViewDetector::trackFrame() and the pose readback per
+// frame. Runs with the stand-in backend, so that only allocations of this code are counted and
+// no license is needed. Fails if the path allocates, e.g. when run in CI. Given a license, it
+// also runs with the synchronous backend and reports the allocations the vlSDK worker makes
+// through the global operator new while processing the commands, without failing on them.
+namespace
+{
+std::atomic<size_t> allocationCount {0};
+
+struct BenchmarkResult
+{
+    size_t failedFrameCount = 0;
+    size_t allocations = 0;
+};
+
+Frame createFrame(const unsigned int cameraCount)
+{
+    Frame frame;
+    for (unsigned int camIdx = 0; camIdx < cameraCount; camIdx++)
+    {
+        frame.push_back(cv::Mat::zeros(480, 640, CV_8UC1));
+    }
+    return frame;
+}
+
+BenchmarkResult runBenchmark(
+    const std::string& name,
+    MultiViewDetector& detector,
+    const size_t frameCount)
+{
+    const auto images = detector.toVLImages(createFrame(detector.getCameraCount()));
+    const std::optional<ExtrinsicDataHelpers::Extrinsic> externalExtrinsic =
+        ExtrinsicDataHelpers::Extrinsic {{0.1f, -0.2f, 0.5f}, {0, 0, 0, 1}, true};
+    const std::optional<ExtrinsicDataHelpers::Extrinsic> noExtrinsic;
+
+    // Warm up, e.g. the metrics are registered on first use
+    detector.trackFrame(images, externalExtrinsic);
+    detector.getExtrinsic();
+
+    BenchmarkResult result;
+    const auto allocationsBefore = allocationCount.load();
+    const auto startTime = std::chrono::steady_clock::now();
+    for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+    {
+        // Alternates between detection and external tracking
+        const auto& extrinsic = frameIdx % 2 == 0 ? externalExtrinsic : noExtrinsic;
+        if (detector.trackFrame(images, extrinsic) != CommandStatus::Ok)
+        {
+            result.failedFrameCount++;
+        }
+        detector.getExtrinsic();
+    }
+    const auto duration = std::chrono::steady_clock::now() - startTime;
+    result.allocations = allocationCount.load() - allocationsBefore;
+
+    std::cout << name << ": " << frameCount << " frames, " << result.failedFrameCount
+              << " failed\n"
+              << static_cast<double>(result.allocations) / frameCount << " allocations per frame\n"
+              << std::chrono::duration<double, std::micro>(duration).count() / frameCount
+              << " us per frame\n";
+    return result;
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto* ptr = std::malloc(size > 0 ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: CommandPathBenchmark <vl-file> [frame-count] [license-file]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string trackingConfigFilepath = argv[1];
+    const size_t frameCount = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+    try
+    {
+        MultiViewDetector standInDetector(
+            std::make_unique<StandInWorkerBackend>(), "", trackingConfigFilepath);
+        const auto standInResult = runBenchmark("StandIn", standInDetector, frameCount);
+
+        if (argc > 3)
+        {
+            MultiViewDetector syncDetector(
+                argv[3], trackingConfigFilepath, WorkerBackendType::Sync);
+            runBenchmark("Sync", syncDetector, frameCount);
+        }
+        return standInResult.allocations == 0 && standInResult.failedFrameCount == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "\nERROR:\n" << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,36 @@
+#include <FrameSources/FrameArchive.h>
+#include <FrameSources/FrameSource.h>
+
+#include <iostream>
+#include <string>
+
+// Packs the multipage TIFF files of an image sequence directory into a frame archive, which is
+// picked up automatically by TrackingDemoMain.
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: FrameArchiveConverter <image-sequence-dir> [--lz4]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string imageDir = argv[1];
+    const auto compression = (argc > 2 && std::string(argv[2]) == "--lz4")
+                                 ? FrameArchive::Compression::LZ4
+                                 : FrameArchive::Compression::None;
+
+    try
+    {
+        TiffFrameSource source(imageDir);
+        const auto archivePath = FrameArchive::composeArchivePath(imageDir);
+        std::cout << "Packing " << source.getFrameCount() << " frames into " << archivePath
+                  << "...\n";
+        const auto frameCount = FrameArchive::pack(source, archivePath, compression);
+        std::cout << "Packed " << frameCount << " frames\n";
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "\nERROR:\n" << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
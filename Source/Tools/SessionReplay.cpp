@@ -0,0 +1,187 @@
+#include <MultiViewDetector.h>
+#include <Recording/SessionRecorder.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Drives a fresh detector with the commands and frames of a recorded session, either at the
+// original pace or as fast as possible, and compares the latency of every frame with the
+// recording.
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct PendingFrame
+{
+    std::future<DetectionResult> result;
+    Clock::time_point submitTime;
+    std::shared_ptr<Clock::time_point> completionTime;
+};
+
+double toMilliseconds(const Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+float getTranslationDifference(
+    const ExtrinsicDataHelpers::Extrinsic& a,
+    const ExtrinsicDataHelpers::Extrinsic& b)
+{
+    float squaredDistance = 0.0f;
+    for (size_t i = 0; i < a.t.size(); i++)
+    {
+        squaredDistance += (a.t[i] - b.t[i]) * (a.t[i] - b.t[i]);
+    }
+    return std::sqrt(squaredDistance);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: SessionReplay <session-file> <vl-file> <license-file> [--fast] "
+                     "[--threaded|--stand-in]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string sessionFilepath = argv[1];
+    const std::string trackingConfigFilepath = argv[2];
+    const std::string licenseFilepath = argv[3];
+    auto asFastAsPossible = false;
+    auto backendType = WorkerBackendType::Sync;
+    for (int argIdx = 4; argIdx < argc; argIdx++)
+    {
+        asFastAsPossible |= std::string(argv[argIdx]) == "--fast";
+        if (std::string(argv[argIdx]) == "--threaded")
+        {
+            backendType = WorkerBackendType::Threaded;
+        }
+        else if (std::string(argv[argIdx]) == "--stand-in")
+        {
+            backendType = WorkerBackendType::StandIn;
+        }
+    }
+
+    try
+    {
+        Recording::SessionReader reader(sessionFilepath);
+        MultiViewDetector detector(licenseFilepath, trackingConfigFilepath, backendType);
+
+        std::map<uint64_t, PendingFrame> pendingFrames;
+        double recordedLatencySumMs = 0.0, replayedLatencySumMs = 0.0;
+        size_t comparedFrameCount = 0;
+
+        std::cout << std::fixed << std::setprecision(2);
+        const auto replayStartTime = Clock::now();
+        Recording::SessionRecord record;
+        while (reader.next(record))
+        {
+            if (!asFastAsPossible)
+            {
+                std::this_thread::sleep_until(replayStartTime + record.timestamp);
+            }
+
+            switch (record.type)
+            {
+                case Recording::RecordType::Command:
+                    if (!record.isPartOfFrame)
+                    {
+                        detector.replayCommand(record.command);
+                    }
+                    break;
+                case Recording::RecordType::Frame:
+                {
+                    auto completionTime = std::make_shared<Clock::time_point>();
+                    DetectionRequest request;
+                    request.frame = record.images;
+                    request.externalExtrinsic = record.externalExtrinsic;
+                    request.fetchLineModelImages = record.fetchLineModelImages;
+                    request.fetchTextureImage = record.fetchTextureImage;
+                    request.onResult = [completionTime](const DetectionResult&)
+                    { *completionTime = Clock::now(); };
+
+                    const auto submitTime = Clock::now();
+                    pendingFrames[record.frameId] = {
+                        detector.submit(std::move(request)), submitTime, completionTime};
+                    break;
+                }
+                case Recording::RecordType::Result:
+                {
+                    auto pendingFrame = pendingFrames.find(record.frameId);
+                    if (pendingFrame == pendingFrames.end())
+                    {
+                        std::cout << "Frame " << record.frameId << " was not recorded\n";
+                        break;
+                    }
+                    const auto result = pendingFrame->second.result.get();
+                    const auto recordedMs = toMilliseconds(record.latency);
+                    const auto replayedMs = toMilliseconds(
+                        *pendingFrame->second.completionTime - pendingFrame->second.submitTime);
+                    pendingFrames.erase(pendingFrame);
+
+                    std::cout << "Frame " << record.frameId << ": recorded " << recordedMs
+                              << " ms, replayed " << replayedMs << " ms, difference "
+                              << replayedMs - recordedMs << " ms";
+                    if (result.extrinsic.valid != record.extrinsic.valid)
+                    {
+                        std::cout << ", pose validity differs";
+                    }
+                    else if (result.extrinsic.valid)
+                    {
+                        std::cout << ", translation differs by "
+                                  << getTranslationDifference(result.extrinsic, record.extrinsic)
+                                  << " m";
+                    }
+                    std::cout << "\n";
+
+                    recordedLatencySumMs += recordedMs;
+                    replayedLatencySumMs += replayedMs;
+                    comparedFrameCount++;
+                    break;
+                }
+                case Recording::RecordType::PixelFormat:
+                    detector.setInputPixelFormat(record.pixelFormat);
+                    break;
+                case Recording::RecordType::Texture:
+                {
+                    // Fetched with getTextureImage() after the frame, which has finished at
+                    // this point, since its result was recorded before
+                    const auto textureImage = detector.getTextureImage();
+                    if (textureImage.cols != record.textureImage.cols ||
+                        textureImage.rows != record.textureImage.rows)
+                    {
+                        std::cout << "Texture of frame " << record.frameId << " has "
+                                  << textureImage.cols << "x" << textureImage.rows
+                                  << " pixels instead of " << record.textureImage.cols << "x"
+                                  << record.textureImage.rows << "\n";
+                    }
+                    break;
+                }
+            }
+        }
+
+        for (auto& pendingFrame : pendingFrames)
+        {
+            pendingFrame.second.result.get();
+            std::cout << "Frame " << pendingFrame.first << " has no recorded result\n";
+        }
+        if (comparedFrameCount > 0)
+        {
+            std::cout << "Mean latency over " << comparedFrameCount << " frames: recorded "
+                      << recordedLatencySumMs / comparedFrameCount << " ms, replayed "
+                      << replayedLatencySumMs / comparedFrameCount << " ms\n";
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "\nERROR:\n" << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
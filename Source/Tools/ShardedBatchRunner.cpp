@@ -0,0 +1,375 @@
+#include <FrameSources/FrameSource.h>
+#include <Helpers/DataProcessingHelpers.h>
+#include <MultiViewDetector.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+// Runs the detection on all frames of an image sequence with several worker processes. The
+// coordinator splits the frame range into shards, launches one process per shard and merges the
+// per-shard results into one file in the format of trackingResults.json. Shards of workers which
+// crash, fail or exceed the shard timeout are handed to another worker.
+namespace
+{
+constexpr auto workerFlag = "--worker";
+constexpr size_t defaultShardSize = 10;
+constexpr size_t maxAttemptsPerShard = 3;
+constexpr std::chrono::seconds defaultShardTimeout{600};
+
+using ExtrinsicMap = std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>;
+
+struct Shard
+{
+    size_t firstFrame;
+    size_t endFrame;
+    size_t attempts = 0;
+};
+
+struct CoordinatorOptions
+{
+    std::string executablePath;
+    std::string trackingConfigFilepath;
+    std::string imageDir;
+    std::string licenseFilepath;
+    size_t workerCount = std::max(1u, std::thread::hardware_concurrency() / 4);
+    size_t shardSize = defaultShardSize;
+    std::chrono::seconds shardTimeout = defaultShardTimeout;
+    std::string outputPath;
+};
+
+enum class ProcessOutcome
+{
+    Succeeded,
+    Failed,
+    TimedOut
+};
+
+std::string quote(const std::string& argument)
+{
+    return "\"" + argument + "\"";
+}
+
+std::string composeShardPath(const std::string& imageDir, const Shard& shard)
+{
+    return imageDir + "/shards/shard_" + std::to_string(shard.firstFrame) + "_" +
+           std::to_string(shard.endFrame) + ".json";
+}
+
+std::vector<Shard> splitIntoShards(const size_t frameCount, const size_t shardSize)
+{
+    std::vector<Shard> shards;
+    for (size_t firstFrame = 0; firstFrame < frameCount; firstFrame += shardSize)
+    {
+        shards.push_back({firstFrame, std::min(firstFrame + shardSize, frameCount)});
+    }
+    return shards;
+}
+
+int runWorker(
+    const std::string& trackingConfigFilepath,
+    const std::string& imageDir,
+    const std::string& licenseFilepath,
+    const size_t firstFrame,
+    const size_t endFrame,
+    const std::string& outputPath)
+{
+    MultiViewDetector detector(licenseFilepath, trackingConfigFilepath);
+    auto frameSource = createFrameSource(imageDir);
+
+    ExtrinsicMap extrinsics;
+    for (size_t frameIdx = firstFrame; frameIdx < endFrame; frameIdx++)
+    {
+        extrinsics[DataProcessingHelpers::composeImageName(frameIdx)] =
+            detector.runDetection(frameSource->loadFrame(frameIdx));
+    }
+
+    // The coordinator treats an existing shard file as finished, so it has to appear at once
+    const auto temporaryPath = outputPath + ".tmp";
+    DataProcessingHelpers::writeExtrinsicsJson(extrinsics, temporaryPath);
+    std::filesystem::rename(temporaryPath, outputPath);
+    return 0;
+}
+
+// argv[0] is not necessarily a path, e.g. if the executable was found via PATH
+std::string getExecutablePath(const char* argv0)
+{
+#ifdef _WIN32
+    std::string path(MAX_PATH, '\0');
+    const auto length = GetModuleFileNameA(nullptr, path.data(), static_cast<DWORD>(path.size()));
+    if (length > 0 && length < path.size())
+    {
+        path.resize(length);
+        return path;
+    }
+#else
+    std::error_code error;
+    const auto path = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (!error)
+    {
+        return path.string();
+    }
+#endif
+    return std::filesystem::absolute(argv0).string();
+}
+
+// Runs the process and kills it if it does not exit before the timeout
+ProcessOutcome runProcess(
+    const std::vector<std::string>& arguments, const std::chrono::seconds timeout)
+{
+#ifdef _WIN32
+    std::string commandLine;
+    for (const auto& argument : arguments)
+    {
+        commandLine += (commandLine.empty() ? "" : " ") + quote(argument);
+    }
+    STARTUPINFOA startupInfo{};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo{};
+    if (!CreateProcessA(
+            nullptr,
+            commandLine.data(),
+            nullptr,
+            nullptr,
+            FALSE,
+            0,
+            nullptr,
+            nullptr,
+            &startupInfo,
+            &processInfo))
+    {
+        std::cerr << "Cannot start " << arguments[0] << ": error " << GetLastError() << "\n";
+        return ProcessOutcome::Failed;
+    }
+    CloseHandle(processInfo.hThread);
+
+    auto outcome = ProcessOutcome::Failed;
+    const auto timeoutMs = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    if (WaitForSingleObject(processInfo.hProcess, static_cast<DWORD>(timeoutMs.count())) ==
+        WAIT_TIMEOUT)
+    {
+        TerminateProcess(processInfo.hProcess, 1);
+        WaitForSingleObject(processInfo.hProcess, INFINITE);
+        outcome = ProcessOutcome::TimedOut;
+    }
+    else
+    {
+        DWORD exitCode = 1;
+        if (GetExitCodeProcess(processInfo.hProcess, &exitCode) && exitCode == 0)
+        {
+            outcome = ProcessOutcome::Succeeded;
+        }
+    }
+    CloseHandle(processInfo.hProcess);
+    return outcome;
+#else
+    std::vector<char*> argv;
+    for (const auto& argument : arguments)
+    {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (const auto error = posix_spawn(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+        error != 0)
+    {
+        std::cerr << "Cannot start " << arguments[0] << ": " << std::strerror(error) << "\n";
+        return ProcessOutcome::Failed;
+    }
+
+    // There is no waitpid with a timeout, so poll until the deadline
+    constexpr std::chrono::milliseconds pollInterval(100);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    int status = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return ProcessOutcome::TimedOut;
+        }
+        std::this_thread::sleep_for(pollInterval);
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? ProcessOutcome::Succeeded
+                                                         : ProcessOutcome::Failed;
+#endif
+}
+
+ProcessOutcome runShardProcess(const CoordinatorOptions& options, const Shard& shard)
+{
+    const auto shardPath = composeShardPath(options.imageDir, shard);
+    std::filesystem::remove(shardPath);
+
+    const auto outcome = runProcess(
+        {options.executablePath,
+         workerFlag,
+         options.trackingConfigFilepath,
+         options.imageDir,
+         options.licenseFilepath,
+         std::to_string(shard.firstFrame),
+         std::to_string(shard.endFrame),
+         shardPath},
+        options.shardTimeout);
+    if (outcome == ProcessOutcome::Succeeded && !std::filesystem::exists(shardPath))
+    {
+        return ProcessOutcome::Failed;
+    }
+    return outcome;
+}
+
+int runCoordinator(const CoordinatorOptions& options)
+{
+    const auto frameCount = createFrameSource(options.imageDir)->getFrameCount();
+    const auto shards = splitIntoShards(frameCount, options.shardSize);
+    std::cout << "Processing " << frameCount << " frames in " << shards.size()
+              << " shards with " << options.workerCount << " worker processes\n";
+
+    std::mutex queueMutex;
+    std::deque<Shard> pendingShards(shards.begin(), shards.end());
+    std::vector<Shard> finishedShards;
+    std::atomic<bool> failed = false;
+
+    std::vector<std::thread> workers;
+    for (size_t workerIdx = 0; workerIdx < options.workerCount; workerIdx++)
+    {
+        workers.emplace_back(
+            [&]()
+            {
+                while (!failed)
+                {
+                    Shard shard;
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        if (pendingShards.empty())
+                        {
+                            return;
+                        }
+                        shard = pendingShards.front();
+                        pendingShards.pop_front();
+                    }
+
+                    shard.attempts++;
+                    const auto outcome = runShardProcess(options, shard);
+
+                    std::lock_guard<std::mutex> lock(queueMutex);
+                    if (outcome == ProcessOutcome::Succeeded)
+                    {
+                        finishedShards.push_back(shard);
+                        std::cout << "Finished frames " << shard.firstFrame << " to "
+                                  << shard.endFrame - 1 << " (" << finishedShards.size() << "/"
+                                  << shards.size() << " shards)\n";
+                    }
+                    else if (shard.attempts < maxAttemptsPerShard)
+                    {
+                        std::cout << "Worker for frames " << shard.firstFrame << " to "
+                                  << shard.endFrame - 1
+                                  << (outcome == ProcessOutcome::TimedOut ? " timed out"
+                                                                          : " failed")
+                                  << ", reassigning shard\n";
+                        pendingShards.push_back(shard);
+                    }
+                    else
+                    {
+                        std::cout << "Giving up on frames " << shard.firstFrame << " to "
+                                  << shard.endFrame - 1 << " after " << shard.attempts
+                                  << " attempts\n";
+                        failed = true;
+                    }
+                }
+            });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    if (failed)
+    {
+        return 1;
+    }
+
+    ExtrinsicMap extrinsics;
+    for (const auto& shard : finishedShards)
+    {
+        const auto shardExtrinsics = DataProcessingHelpers::loadTrackingResults(
+            std::filesystem::path(composeShardPath(options.imageDir, shard)));
+        extrinsics.insert(shardExtrinsics.begin(), shardExtrinsics.end());
+    }
+    DataProcessingHelpers::writeExtrinsicsJson(extrinsics, options.outputPath);
+    std::cout << "Merged results of " << extrinsics.size() << " frames into "
+              << options.outputPath << "\n";
+    return 0;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        if (argc > 1 && std::string(argv[1]) == workerFlag)
+        {
+            if (argc < 8)
+            {
+                std::cout << "Usage: ShardedBatchRunner " << workerFlag
+                          << " <vl-file> <image-sequence-dir> <license-file> <first-frame> "
+                             "<end-frame> <output-json>\n";
+                return EXIT_FAILURE;
+            }
+            return runWorker(
+                argv[2], argv[3], argv[4], std::stoul(argv[5]), std::stoul(argv[6]), argv[7]);
+        }
+
+        if (argc < 4)
+        {
+            std::cout << "Usage: ShardedBatchRunner <vl-file> <image-sequence-dir> <license-file> "
+                         "[worker-count] [shard-size] [shard-timeout-seconds]\n";
+            return EXIT_FAILURE;
+        }
+        CoordinatorOptions options;
+        options.executablePath = getExecutablePath(argv[0]);
+        options.trackingConfigFilepath = argv[1];
+        options.imageDir = argv[2];
+        options.licenseFilepath = argv[3];
+        if (argc > 4)
+        {
+            options.workerCount = std::max<size_t>(1, std::stoul(argv[4]));
+        }
+        if (argc > 5)
+        {
+            options.shardSize = std::max<size_t>(1, std::stoul(argv[5]));
+        }
+        if (argc > 6)
+        {
+            options.shardTimeout = std::chrono::seconds(std::max<long>(1, std::stol(argv[6])));
+        }
+        options.outputPath = options.imageDir + "/shards/trackingResults.json";
+        return runCoordinator(options);
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "\nERROR:\n" << e.what() << "\n";
+        return 1;
+    }
+}
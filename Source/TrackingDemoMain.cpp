@@ -1,6 +1,14 @@
+#include <Caching/InitStateCache.h>
+#include <FrameSources/FrameSource.h>
 #include <Helpers/DataProcessingHelpers.h>
 #include <Helpers/ImageHelpers.h>
+#include <Metrics/MetricsRegistry.h>
 #include <MultiViewDetector.h>
+#include <Scheduling/CpuTopology.h>
+#include <Scheduling/DetectionScheduler.h>
+#include <Scheduling/JitterBenchmark.h>
+#include <Texture/TextureAccumulator.h>
+#include <Texture/TextureMappingConfig.h>
 #include <Visualization/ResultVisualization.h>
 
 #include <nlohmann/json.hpp>
@@ -8,8 +16,12 @@
 #include <opencv2/imgcodecs.hpp>
 #include <vlSDK.h>
 
+#include <chrono>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <optional>
+#include <thread>
 #include <vector>
 
 namespace
@@ -17,65 +29,56 @@ namespace
 constexpr int frameCount = 2;
 constexpr auto visualizeResults = true;
 constexpr auto extractTexture = true;
+// Fuses the textures of all frames into one atlas instead of writing one texture per frame
+constexpr auto fuseTextures = false;
 constexpr auto useExternalTracking = true;
+// Set to the layout delivered by the cameras, e.g. PixelFormat::BayerRGGB for raw sensor images
+constexpr auto inputPixelFormat = ImageHelpers::PixelFormat::Grey;
+// StandIn runs the pipeline without license, using the poses from trackingResults.json
+constexpr auto workerBackendType = WorkerBackendType::Sync;
+// Compares the synchronous and the threaded worker backend instead of running the demo. With
+// the StandIn backend, measures the throughput of the pipeline around the detector instead.
+constexpr auto benchmarkWorkerBackends = false;
+// Measures the latency jitter of concurrent detectors with and without thread pinning
+constexpr auto benchmarkThreadPinning = false;
+constexpr size_t benchmarkDetectorCount = 2;
+// Runs a batch next to live requests with deadlines through a DetectionScheduler
+constexpr auto benchmarkScheduler = false;
+constexpr auto liveRequestDeadline = std::chrono::milliseconds(500);
+// Rewrites a file with the metrics in Prometheus text format while running
+constexpr auto exportMetrics = false;
+constexpr auto metricsExportInterval = std::chrono::seconds(1);
+// Records the session for offline reproduction with SessionReplay
+constexpr auto recordSession = false;
+// Stores the learned init data, so that later runs and further detectors start faster
+constexpr auto cacheInitState = false;
 
 using Frame = std::vector<cv::Mat>;
 
-struct TextureMappingConfig
+std::string composeTexturePath(const std::string& imageDir, const size_t frameIdx)
 {
-    enum BRIGHTNESS_CORRECTION_METHOD
-    {
-        EXPLICIT_CONTRAST_MEAN = 0,
-        TOTAL_LEAST_SQUARES = 1
-    };
-
-    BRIGHTNESS_CORRECTION_METHOD method = TOTAL_LEAST_SQUARES;
-    // threshold values between 0 and 1
-    float minScoreForOptimization = 0.4f;
-    float whiteOutlierMaxScore = 0.8f;
-    float whiteOutlierMinValue = 0.8f;
-    // relevant only for EXPLICIT_CONTRAST_MEAN method
-    int referenceFrameID = 0;
-
-    int stride = 3;
-    int width = 1024;
-    int height = 1024;
-    bool verbose = false;
-
-    nlohmann::json toJson()
-    {
-        nlohmann::json config;
-        config["method"] = static_cast<int>(method);
-        config["minScoreForOptimization"] = minScoreForOptimization;
-        config["whiteOutlierMaxScore"] = whiteOutlierMaxScore;
-        config["whiteOutlierMinValue"] = whiteOutlierMinValue;
-        config["referenceFrameID"] = referenceFrameID;
-        config["stride"] = stride;
-        config["width"] = width;
-        config["height"] = height;
-        config["verbose"] = verbose;
-        return config;
-    }
-};
+    return imageDir + "/extracted_textures/texture_from_" +
+           DataProcessingHelpers::composeImageName(frameIdx) + ".png";
+}
 
-std::string composeImageName(const size_t frameIdx)
+std::string composeTextureAtlasPath(const std::string& imageDir)
 {
-    return "multiViewImage_" + std::to_string(frameIdx);
+    return imageDir + "/extracted_textures/texture_atlas.png";
 }
 
-std::string composeImagePath(const std::string& imageDir, const size_t frameIdx)
+std::string composeMetricsPath(const std::string& imageDir)
 {
-    return imageDir + "/" + composeImageName(frameIdx) + ".tif";
+    return imageDir + "/metrics/vldemo.prom";
 }
 
-std::string composeTexturePath(const std::string& imageDir, const size_t frameIdx)
+std::string composeSessionPath(const std::string& imageDir)
 {
-    return imageDir + "/extracted_textures/texture_from_" + composeImageName(frameIdx) + ".png";
+    return imageDir + "/sessions/session.vlsession";
 }
 
-Frame getNextFrame(const std::string& imageDir, const size_t frameIdx)
+std::string composeInitStateCachePath(const std::string& imageDir)
 {
-    return DataProcessingHelpers::loadFrame(composeImagePath(imageDir, frameIdx));
+    return imageDir + "/cache";
 }
 
 void writeTextureImage(const cv::Mat& cvImage, const std::string& imageDir, const size_t& frameIdx)
@@ -89,7 +92,7 @@ ExtrinsicDataHelpers::Extrinsic getTrackingResult(
     const std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>& extrinsics,
     const size_t& frameIdx)
 {
-    const auto imgFileName = composeImageName(frameIdx);
+    const auto imgFileName = DataProcessingHelpers::composeImageName(frameIdx);
 
     if (extrinsics.find(imgFileName) == extrinsics.end())
     {
@@ -99,6 +102,155 @@ ExtrinsicDataHelpers::Extrinsic getTrackingResult(
 
     return extrinsics.at(imgFileName);
 }
+
+// Submits all frames back to back. With the threaded backend, loading and converting frame
+// N+1 overlaps with tracking frame N.
+std::chrono::milliseconds benchmarkWorkerBackend(
+    const WorkerBackendType backendType,
+    const std::string& licenseFilepath,
+    const std::string& trackingConfigFilepath,
+    FrameSource& frameSource,
+    const std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>& extrinsics)
+{
+    MultiViewDetector detector(licenseFilepath, trackingConfigFilepath, backendType);
+    detector.setInputPixelFormat(inputPixelFormat);
+    detector.enableTextureMapping(extractTexture, TextureMappingConfig().toJson());
+    detector.disablePoseEstimation(useExternalTracking);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    std::vector<std::future<DetectionResult>> results;
+    for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+    {
+        DetectionRequest request;
+        request.frame = frameSource.loadFrame(frameIdx);
+        if (useExternalTracking)
+        {
+            request.externalExtrinsic = getTrackingResult(extrinsics, frameIdx);
+        }
+        request.fetchTextureImage = extractTexture;
+        results.push_back(detector.submit(std::move(request)));
+    }
+    for (auto& result : results)
+    {
+        result.get();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+}
+
+void benchmarkThreadPinningJitter(
+    const std::string& licenseFilepath,
+    const std::string& trackingConfigFilepath,
+    FrameSource& frameSource,
+    const std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>& extrinsics)
+{
+    // Frames are loaded up front, so that disk access does not add to the jitter
+    std::vector<Frame> frames;
+    for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+    {
+        frames.push_back(frameSource.loadFrame(frameIdx));
+    }
+
+    const auto createDetector = [&]()
+    {
+        auto detector = std::make_unique<MultiViewDetector>(
+            licenseFilepath, trackingConfigFilepath, WorkerBackendType::Threaded);
+        detector->setInputPixelFormat(inputPixelFormat);
+        detector->disablePoseEstimation(useExternalTracking);
+        return detector;
+    };
+    const auto createRequest = [&](const size_t requestIdx)
+    {
+        DetectionRequest request;
+        request.frame = frames[requestIdx % frames.size()];
+        if (useExternalTracking)
+        {
+            request.externalExtrinsic = getTrackingResult(extrinsics, requestIdx % frames.size());
+        }
+        return request;
+    };
+
+    const auto topology = Scheduling::readCpuTopology();
+    std::cout << topology.cpus.size() << " CPUs on " << topology.numaNodes.size()
+              << " NUMA node(s)\n";
+    const auto runBenchmark = [&](const bool pinThreads, const size_t framesPerDetector)
+    {
+        Scheduling::JitterBenchmarkConfig config;
+        config.detectorCount = benchmarkDetectorCount;
+        config.framesPerDetector = framesPerDetector;
+        config.pinThreads = pinThreads;
+        return Scheduling::runJitterBenchmark(config, createDetector, createRequest);
+    };
+
+    // Unmeasured, so that cold caches and first-time initialization do not count against the
+    // first configuration. The order is alternated for the same reason.
+    runBenchmark(false, frames.size());
+    for (const auto pinThreads : {false, true, true, false})
+    {
+        const auto statistics =
+            runBenchmark(pinThreads, Scheduling::JitterBenchmarkConfig().framesPerDetector);
+        std::cout << (pinThreads ? "Pinned: " : "Unpinned: ") << to_string(statistics) << "\n";
+    }
+}
+
+// Reprocesses all frames as a batch several times while one live request per frame is submitted
+// at a fixed pace, and reports the deadline misses per priority class
+void benchmarkMixedLoadScheduling(
+    const std::string& licenseFilepath,
+    const std::string& trackingConfigFilepath,
+    FrameSource& frameSource,
+    const std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>& extrinsics)
+{
+    constexpr size_t batchRepetitions = 5;
+    std::vector<std::unique_ptr<MultiViewDetector>> detectors;
+    for (size_t detectorIdx = 0; detectorIdx < benchmarkDetectorCount; detectorIdx++)
+    {
+        detectors.push_back(std::make_unique<MultiViewDetector>(
+            licenseFilepath, trackingConfigFilepath, workerBackendType));
+        detectors.back()->setInputPixelFormat(inputPixelFormat);
+        detectors.back()->disablePoseEstimation(useExternalTracking);
+    }
+    Scheduling::DetectionScheduler scheduler(std::move(detectors));
+
+    const auto createRequest = [&](const size_t frameIdx)
+    {
+        DetectionRequest request;
+        request.frame = frameSource.loadFrame(frameIdx);
+        if (useExternalTracking)
+        {
+            request.externalExtrinsic = getTrackingResult(extrinsics, frameIdx);
+        }
+        return request;
+    };
+
+    std::vector<DetectionRequest> batch;
+    for (size_t repetition = 0; repetition < batchRepetitions; repetition++)
+    {
+        for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+        {
+            batch.push_back(createRequest(frameIdx));
+        }
+    }
+    auto results = scheduler.submitBatch(std::move(batch));
+
+    for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
+    {
+        auto request = createRequest(frameIdx);
+        request.deadline = std::chrono::steady_clock::now() + liveRequestDeadline;
+        results.push_back(scheduler.submit(std::move(request), Scheduling::PriorityClass::Live));
+        std::this_thread::sleep_for(liveRequestDeadline / 2);
+    }
+    for (auto& result : results)
+    {
+        result.wait();
+    }
+
+    for (const auto priority : {Scheduling::PriorityClass::Live, Scheduling::PriorityClass::Batch})
+    {
+        std::cout << to_string(priority) << ": " << to_string(scheduler.getStatistics(priority))
+                  << "\n";
+    }
+}
 } // namespace
 
 //    The detection result is an extrinsic and consists of:
@@ -126,11 +278,71 @@ int main(int argc, char* argv[])
 
     try
     {
+        std::optional<Metrics::TextFileExporter> metricsExporter;
+        if (exportMetrics)
+        {
+            metricsExporter.emplace(composeMetricsPath(imageDir), metricsExportInterval);
+        }
+
+        if (cacheInitState)
+        {
+            InitStateCache::global().setDirectory(composeInitStateCachePath(imageDir));
+        }
+
+        // Uses the frame archive created by FrameArchiveConverter if there is one
+        auto frameSource = createFrameSource(imageDir);
+
+        if (benchmarkWorkerBackends || benchmarkThreadPinning || benchmarkScheduler)
+        {
+            const auto extrinsics =
+                useExternalTracking
+                    ? DataProcessingHelpers::loadTrackingResults(imageDir + "/trackingResults.json")
+                    : std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic>();
+            if (benchmarkScheduler)
+            {
+                benchmarkMixedLoadScheduling(
+                    licenseFilepath, trackingConfigFilepath, *frameSource, extrinsics);
+                return 0;
+            }
+            if (benchmarkThreadPinning)
+            {
+                benchmarkThreadPinningJitter(
+                    licenseFilepath, trackingConfigFilepath, *frameSource, extrinsics);
+                return 0;
+            }
+            const auto backendTypes =
+                workerBackendType == WorkerBackendType::StandIn
+                    ? std::vector<WorkerBackendType> {WorkerBackendType::StandIn}
+                    : std::vector<WorkerBackendType> {
+                          WorkerBackendType::Sync, WorkerBackendType::Threaded};
+            for (const auto backendType : backendTypes)
+            {
+                const auto duration = benchmarkWorkerBackend(
+                    backendType, licenseFilepath, trackingConfigFilepath, *frameSource, extrinsics);
+                std::cout << to_string(backendType) << " worker backend: " << frameCount
+                          << " frames in " << duration.count() << " ms\n";
+            }
+            return 0;
+        }
+
         std::cout << "Creating detector...\n\n";
-        MultiViewDetector detector(licenseFilepath, trackingConfigFilepath);
+        MultiViewDetector detector(licenseFilepath, trackingConfigFilepath, workerBackendType);
+        detector.setInputPixelFormat(inputPixelFormat);
+        const auto& startupReport = detector.getStartupReport();
+        std::cout << "Detector started " << (startupReport.isWarm() ? "warm" : "cold") << " in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         startupReport.duration)
+                         .count()
+                  << " ms\n\n";
+        if (recordSession)
+        {
+            detector.enableSessionRecording(composeSessionPath(imageDir));
+        }
 
+        const TextureMappingConfig textureMappingConfig;
         detector.enableTextureMapping(
-            extractTexture, TextureMappingConfig().toJson()); // config is optional
+            extractTexture, textureMappingConfig.toJson()); // config is optional
+        TextureAccumulator textureAccumulator(textureMappingConfig);
 
         std::unordered_map<std::string, ExtrinsicDataHelpers::Extrinsic> extrinsics;
         if (useExternalTracking)
@@ -146,7 +358,7 @@ int main(int argc, char* argv[])
         for (size_t frameIdx = 0; frameIdx < frameCount; frameIdx++)
         {
             std::cout << "Loading Frame " << frameIdx << "...\n";
-            const auto frame = getNextFrame(imageDir, frameIdx);
+            const auto frame = frameSource->loadFrame(frameIdx);
 
             ExtrinsicDataHelpers::Extrinsic extrinsic;
             if (!useExternalTracking)
@@ -166,10 +378,18 @@ int main(int argc, char* argv[])
             if (extractTexture)
             {
                 const auto& textureImage = detector.getTextureImage();
-                writeTextureImage(textureImage, imageDir, frameIdx);
+                if (fuseTextures)
+                {
+                    // Textures mapped with an invalid pose are not fused
+                    textureAccumulator.accumulate(textureImage, extrinsic.valid ? 1.0f : 0.0f);
+                }
+                else
+                {
+                    writeTextureImage(textureImage, imageDir, frameIdx);
 
-                std::cout << "Saved the extracted texture in "
-                          << composeTexturePath(imageDir, frameIdx) << "\n\n";
+                    std::cout << "Saved the extracted texture in "
+                              << composeTexturePath(imageDir, frameIdx) << "\n\n";
+                }
 
                 if (visualizeResults)
                 {
@@ -186,6 +406,13 @@ int main(int argc, char* argv[])
                     "Detection Results");
             }
         }
+
+        if (extractTexture && fuseTextures)
+        {
+            textureAccumulator.writeAtlas(composeTextureAtlasPath(imageDir));
+            std::cout << "Saved the texture fused from " << textureAccumulator.getFrameCount()
+                      << " frames in " << composeTextureAtlasPath(imageDir) << "\n\n";
+        }
     }
     catch (const std::exception& e)
     {
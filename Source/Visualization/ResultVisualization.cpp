@@ -9,7 +9,14 @@ cv::Mat combineView(const cv::Mat& cameraImage, const cv::Mat& lineModelImage)
 {
     cv::Mat resizedImage;
     cv::resize(cameraImage, resizedImage, lineModelImage.size());
-    cv::cvtColor(resizedImage, resizedImage, cv::COLOR_GRAY2RGB);
+    if (resizedImage.channels() == 1)
+    {
+        cv::cvtColor(resizedImage, resizedImage, cv::COLOR_GRAY2RGB);
+    }
+    else if (resizedImage.channels() == 4)
+    {
+        cv::cvtColor(resizedImage, resizedImage, cv::COLOR_BGRA2BGR);
+    }
     resizedImage += lineModelImage;
     return resizedImage;
 }